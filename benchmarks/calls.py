@@ -0,0 +1,35 @@
+"""Per-call latency of the small, hot CircularBuffer methods.
+
+Usage: python benchmarks/calls.py [number]
+"""
+import sys
+import timeit
+
+
+SETUP = '''
+from circularbuffer import CircularBuffer
+buf = CircularBuffer(1 << 16)
+buf.write(b'x' * 1000 + b'needle' + b'x' * 1000)
+'''
+
+CALLS = [
+    ('write+read', 'buf.write(b"0123456789"); buf.read(10)'),
+    ('write(data=)+read(size=)', 'buf.write(data=b"0123"); buf.read(size=4)'),
+    ('find', 'buf.find(b"needle")'),
+    ('find(start, end)', 'buf.find(b"x", 10, 20)'),
+    ('index', 'buf.index(b"x")'),
+    ('count', 'buf.count(b"needle")'),
+    ('startswith', 'buf.startswith(b"x")'),
+    ('write_available', 'buf.write_available()'),
+]
+
+
+def main():
+    number = int(sys.argv[1]) if len(sys.argv) > 1 else 200000
+    for name, statement in CALLS:
+        best = min(timeit.repeat(statement, SETUP, number=number, repeat=5))
+        print('%-26s %7.1f ns' % (name, best / number * 1e9))
+
+
+if __name__ == '__main__':
+    main()
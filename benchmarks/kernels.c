@@ -0,0 +1,389 @@
+/*
+ * Microbenchmark of the helpers in src/base.c, without Python call overhead.
+ *
+ * The extension is linked into an embedded interpreter, so the kernels run
+ * exactly as they do in the module. Buffer sizes, fill levels and wrap
+ * positions are swept, every line of the output is one measurement:
+ *
+ *   kernel,size,fill,wrap,ns_per_call,cycles_per_byte,cache_misses,
+ *   branch_misses
+ *
+ * Hardware counters come from perf_event_open() on Linux, they are empty
+ * when the kernel does not allow it (see /proc/sys/kernel/perf_event_paranoid).
+ * Cycles then fall back to the time stamp counter on x86, which ticks at
+ * a constant rate rather than the actual clock.
+ */
+#define PY_SSIZE_T_CLEAN
+#include "base.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __linux__
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+#if PY_MAJOR_VERSION < 3
+    #error "the benchmark embeds python 3"
+#endif
+
+PyMODINIT_FUNC PyInit_circularbuffer(void);
+
+
+/* hardware counters */
+
+
+enum {
+    COUNTER_CYCLES,
+    COUNTER_CACHE_MISSES,
+    COUNTER_BRANCH_MISSES,
+    COUNTER_COUNT
+};
+
+static int counters[COUNTER_COUNT] = {-1, -1, -1};
+
+
+static void counters_open(void)
+{
+#ifdef __linux__
+    static const uint64_t configs[COUNTER_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+    };
+
+    for (int i = 0; i < COUNTER_COUNT; i++)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[i];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        counters[i] = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+    if (counters[COUNTER_CYCLES] < 0)
+    {
+        fprintf(stderr, "perf_event_open() is not available, cycles are "
+                "time stamp counter ticks\n");
+    }
+#endif
+}
+
+
+static void counters_start(void)
+{
+#ifdef __linux__
+    for (int i = 0; i < COUNTER_COUNT; i++)
+    {
+        if (counters[i] >= 0)
+        {
+            ioctl(counters[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counters[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+
+static void counters_stop(long long values[COUNTER_COUNT])
+{
+    for (int i = 0; i < COUNTER_COUNT; i++)
+    {
+        values[i] = -1;
+#ifdef __linux__
+        if (counters[i] >= 0)
+        {
+            ioctl(counters[i], PERF_EVENT_IOC_DISABLE, 0);
+            if (read(counters[i], &values[i], sizeof(values[i]))
+                    != sizeof(values[i]))
+            {
+                values[i] = -1;
+            }
+        }
+#endif
+    }
+}
+
+
+static long long time_stamp(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return (long long) __builtin_ia32_rdtsc();
+#else
+    return -1;
+#endif
+}
+
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+/* buffer states */
+
+
+/*
+ * Place fill bytes of data so that it starts at wrap bytes before the end of
+ * internal buffer, or at its start when wrap is 0.
+ */
+static void buffer_place(CircularBuffer* self, Py_ssize_t fill,
+        Py_ssize_t wrap)
+{
+    Py_ssize_t ring = self->allocated + 1;
+
+    self->read = wrap ? ring - wrap : 0;
+    self->write = (self->read + fill) % ring;
+    self->allocated_before_resize = self->allocated;
+    self->raw[self->write] = 0;
+}
+
+
+/* kernels, each returns number of bytes or positions it has processed */
+
+
+typedef Py_ssize_t (*kernel_function)(CircularBuffer*, Py_ssize_t,
+        Py_ssize_t);
+
+
+static Py_ssize_t kernel_find(CircularBuffer* self, Py_ssize_t fill,
+        Py_ssize_t wrap)
+{
+    // not present, the whole data is scanned
+    Py_ssize_t found = circularbuffer_find(self, "needle!", 7, 0, -1);
+    if (found >= 0)
+    {
+        fprintf(stderr, "unexpected match at %zd\n", found);
+    }
+    return fill;
+}
+
+
+static Py_ssize_t kernel_peek_partial(CircularBuffer* self, Py_ssize_t fill,
+        Py_ssize_t wrap)
+{
+    PyObject* copy = circularbuffer_peek_partial(self, 0, fill);
+    Py_XDECREF(copy);
+    return fill;
+}
+
+
+static Py_ssize_t kernel_make_contiguous(CircularBuffer* self,
+        Py_ssize_t fill, Py_ssize_t wrap)
+{
+    buffer_place(self, fill, wrap);
+    if (circularbuffer_make_contiguous(self))
+    {
+        PyErr_Print();
+    }
+    return fill;
+}
+
+
+/*
+ * Realignment through a temporary buffer of half the size, as it was done
+ * before the in-place rotation, kept to compare with.
+ */
+static Py_ssize_t kernel_make_contiguous_copy(CircularBuffer* self,
+        Py_ssize_t fill, Py_ssize_t wrap)
+{
+    buffer_place(self, fill, wrap);
+    if (self->write >= self->read)
+    {
+        return fill;
+    }
+
+    Py_ssize_t half_size = (self->allocated - 1) / 2 + 1;
+    Py_ssize_t first = self->allocated + 1 - self->read;
+    Py_ssize_t second = self->write;
+
+    char* tmp = PyMem_Malloc(half_size);
+    if (tmp == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        return fill;
+    }
+    if (second <= first)
+    {
+        memcpy(tmp, self->raw, second);
+        memmove(self->raw, &self->raw[self->read], first);
+        memcpy(&self->raw[first], tmp, second);
+    }
+    else
+    {
+        memcpy(tmp, &self->raw[self->read], first);
+        memmove(&self->raw[first], self->raw, second);
+        memcpy(self->raw, tmp, first);
+    }
+    PyMem_Free(tmp);
+
+    self->read = 0;
+    self->write = fill;
+    self->raw[fill] = 0;
+    return fill;
+}
+
+
+static Py_ssize_t kernel_translated_position(CircularBuffer* self,
+        Py_ssize_t fill, Py_ssize_t wrap)
+{
+    Py_ssize_t sum = 0;
+    for (Py_ssize_t pos = 0; pos < fill; pos += 61)
+    {
+        sum += circularbuffer_translated_position(self, pos);
+    }
+    // keep the loop from being optimised away
+    if (sum == -1)
+    {
+        fprintf(stderr, "%zd\n", sum);
+    }
+    return fill / 61 + 1;
+}
+
+
+static const struct {
+    const char* name;
+    kernel_function function;
+} kernels[] = {
+    {"find", kernel_find},
+    {"peek_partial", kernel_peek_partial},
+    {"make_contiguous", kernel_make_contiguous},
+    {"make_contiguous_copy", kernel_make_contiguous_copy},
+    {"translated_position", kernel_translated_position},
+};
+
+
+/* sweep */
+
+
+static const Py_ssize_t sizes[] = {4096, 65536, 1 << 20, 16 << 20};
+static const int fill_percents[] = {25, 50, 95};
+// how far before the end of internal buffer the data starts, in percent of
+// fill, 0 means the data does not wrap around
+static const int wrap_percents[] = {0, 10, 50};
+
+
+static void measure(CircularBuffer* self, int kernel, Py_ssize_t fill,
+        Py_ssize_t wrap)
+{
+    // roughly 64 MiB of work per measurement, at least a few calls
+    Py_ssize_t calls = ((Py_ssize_t) 64 << 20) / (fill + 1);
+    if (calls < 8)
+    {
+        calls = 8;
+    }
+
+    // warm up caches and branch predictors
+    buffer_place(self, fill, wrap);
+    kernels[kernel].function(self, fill, wrap);
+
+    long long values[COUNTER_COUNT];
+    Py_ssize_t bytes = 0;
+
+    buffer_place(self, fill, wrap);
+    double start = now();
+    long long start_stamp = time_stamp();
+    counters_start();
+    for (Py_ssize_t i = 0; i < calls; i++)
+    {
+        bytes += kernels[kernel].function(self, fill, wrap);
+    }
+    counters_stop(values);
+    long long stamps = time_stamp() - start_stamp;
+    double elapsed = now() - start;
+
+    if (values[COUNTER_CYCLES] < 0 && start_stamp >= 0)
+    {
+        values[COUNTER_CYCLES] = stamps;
+    }
+
+    printf("%s,%zd,%zd,%zd,%.1f,", kernels[kernel].name, self->allocated,
+            fill, wrap, elapsed / calls);
+    if (values[COUNTER_CYCLES] >= 0)
+    {
+        printf("%.3f", (double) values[COUNTER_CYCLES] / bytes);
+    }
+    for (int i = COUNTER_CACHE_MISSES; i < COUNTER_COUNT; i++)
+    {
+        if (values[i] >= 0)
+        {
+            printf(",%.1f", (double) values[i] / calls);
+        }
+        else
+        {
+            printf(",");
+        }
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+
+int main(int argc, char** argv)
+{
+    const char* only = argc > 1 ? argv[1] : NULL;
+
+    PyImport_AppendInittab("circularbuffer", PyInit_circularbuffer);
+    Py_Initialize();
+
+    PyObject* module = PyImport_ImportModule("circularbuffer");
+    if (module == NULL)
+    {
+        PyErr_Print();
+        return 1;
+    }
+    PyObject* type = PyObject_GetAttrString(module, "CircularBuffer");
+
+    counters_open();
+    printf("kernel,size,fill,wrap,ns_per_call,cycles_per_byte,cache_misses,"
+            "branch_misses\n");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        CircularBuffer* self = (CircularBuffer*) PyObject_CallFunction(type,
+                "n", sizes[s]);
+
+        if (self == NULL)
+        {
+            PyErr_Print();
+            return 1;
+        }
+        memset(self->raw, 'x', self->allocated + 2);
+
+        for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++)
+        {
+            if (only && strcmp(only, kernels[k].name) != 0)
+            {
+                continue;
+            }
+            for (size_t f = 0; f < sizeof(fill_percents) / sizeof(int); f++)
+            {
+                for (size_t w = 0; w < sizeof(wrap_percents) / sizeof(int);
+                        w++)
+                {
+                    Py_ssize_t fill = sizes[s] * fill_percents[f] / 100;
+                    Py_ssize_t wrap = fill * wrap_percents[w] / 100;
+                    measure(self, (int) k, fill, wrap);
+                }
+            }
+        }
+        Py_DECREF(self);
+    }
+
+    Py_DECREF(type);
+    Py_DECREF(module);
+    Py_Finalize();
+    return 0;
+}
@@ -0,0 +1,314 @@
+"""Benchmark suite comparing CircularBuffer with the usual pure Python queues.
+
+Usage: python benchmarks/suite.py [--json results.json] [--compare old.json]
+                                  [--quick] [group]
+
+Every benchmark reports the best time of a few repeats, in seconds per
+operation, and the throughput where it makes sense. With --json the results
+are saved, and --compare prints the ratio against a previous run so
+regressions between releases stand out.
+"""
+import argparse
+import collections
+import io
+import json
+import platform
+import re
+import sys
+import time
+
+from circularbuffer import BufferPool, CircularBuffer
+
+
+CHUNK_SIZES = [1, 16, 256, 4096, 65536, 1 << 20]
+FILL_LEVELS = [0.1, 0.5, 0.9]
+HAYSTACK = 1 << 20
+
+
+def best_of(function, number, repeat):
+    """Best time per call of function(number)."""
+    best = None
+    for _ in range(repeat):
+        start = time.perf_counter()
+        function(number)
+        elapsed = (time.perf_counter() - start) / number
+        best = elapsed if best is None or elapsed < best else best
+    return best
+
+
+def iterations(size, quick):
+    """Enough calls to move a few megabytes, but not too few."""
+    total = (4 << 20) if quick else (64 << 20)
+    return max(100, min(100000, total // size))
+
+
+# queues, each moving chunk sized data in and out
+
+
+def circular_buffer(chunk, wrap):
+    # the ring modulus is size + 1, align it to chunks or not
+    size = chunk * 4 - 1 + (chunk // 2 + 1 if wrap else 0)
+    buf = CircularBuffer(max(size, 2))
+    data = b'x' * chunk
+
+    def run(number):
+        write = buf.write
+        read = buf.read
+        for _ in range(number):
+            write(data)
+            read(chunk)
+    return run
+
+
+def bytearray_del(chunk, wrap):
+    buf = bytearray()
+    data = b'x' * chunk
+
+    def run(number):
+        for _ in range(number):
+            buf.extend(data)
+            bytes(buf[:chunk])
+            del buf[:chunk]
+    return run
+
+
+def bytes_io(chunk, wrap):
+    buf = io.BytesIO()
+    data = b'x' * chunk
+
+    def run(number):
+        for _ in range(number):
+            buf.seek(0)
+            buf.write(data)
+            buf.seek(0)
+            buf.read(chunk)
+    return run
+
+
+def deque_chunks(chunk, wrap):
+    # only moves references, the lower bound of any queue
+    buf = collections.deque()
+    data = b'x' * chunk
+
+    def run(number):
+        for _ in range(number):
+            buf.append(data)
+            buf.popleft()
+    return run
+
+
+QUEUES = [
+    ('CircularBuffer', circular_buffer),
+    ('bytearray+del', bytearray_del),
+    ('BytesIO', bytes_io),
+    ('deque', deque_chunks),
+]
+
+
+def bench_throughput(quick):
+    for chunk in CHUNK_SIZES:
+        number = iterations(chunk, quick)
+        for wrap in (False, True):
+            for name, factory in QUEUES:
+                if wrap and name != 'CircularBuffer':
+                    continue
+                label = 'write+read/%s/%d%s' % (name, chunk,
+                                                '/wrapping' if wrap else '')
+                seconds = best_of(factory(chunk, wrap), number, 3)
+                yield label, seconds, chunk / seconds
+
+
+def filled_buffer(hit):
+    buf = CircularBuffer(HAYSTACK)
+    # wrap the data around the end of internal buffer
+    buf.write(b'x' * (HAYSTACK // 2))
+    buf.read(HAYSTACK // 2)
+    tail = b'needle' if hit else b'nodlee'
+    buf.write(b'x' * (HAYSTACK - 100) + tail)
+    return buf
+
+
+def bench_search(quick):
+    number = 20 if quick else 200
+    for hit in (True, False):
+        suffix = 'hit' if hit else 'miss'
+        buf = filled_buffer(hit)
+        raw = bytearray(str(buf).encode())
+
+        def run_find(number, buf=buf):
+            for _ in range(number):
+                buf.find(b'needle')
+
+        def run_count(number, buf=buf):
+            for _ in range(number):
+                buf.count(b'needle')
+
+        def run_bytearray(number, raw=raw):
+            for _ in range(number):
+                raw.find(b'needle')
+
+        for label, function in (('find/CircularBuffer', run_find),
+                                ('count/CircularBuffer', run_count),
+                                ('find/bytearray', run_bytearray)):
+            seconds = best_of(function, number, 3)
+            yield '%s/%s' % (label, suffix), seconds, HAYSTACK / seconds
+
+
+def bench_make_contiguous(quick):
+    size = HAYSTACK
+    for level in FILL_LEVELS:
+        fill = int(size * level)
+        best = None
+        for _ in range(5 if quick else 20):
+            buf = CircularBuffer(size)
+            buf.write(b'x' * (size - fill // 2))
+            buf.read(size - fill // 2)
+            buf.write(b'x' * fill)
+
+            start = time.perf_counter()
+            buf.make_contiguous()
+            elapsed = time.perf_counter() - start
+            best = elapsed if best is None or elapsed < best else best
+        yield 'make_contiguous/%d%%' % (level * 100), best, fill / best
+
+    # drained buffer only moves back to the start
+    buf = CircularBuffer(size)
+    data = b'x' * 10
+
+    def run_empty(number):
+        for _ in range(number):
+            buf.write(data)
+            buf.read(10)
+            buf.make_contiguous()
+    yield 'make_contiguous/empty', best_of(run_empty, 1000, 3), None
+
+
+def bench_regex(quick):
+    number = 20 if quick else 200
+    pattern = re.compile(b'x{10}')
+    buf = filled_buffer(True)
+
+    def run_buffer(number):
+        for _ in range(number):
+            with buf:
+                pattern.match(memoryview(buf))
+
+    def run_view(number):
+        for _ in range(number):
+            view = buf.view(0, 256)
+            pattern.match(view)
+            view.release()
+
+    yield 're.match/buffer protocol', best_of(run_buffer, number, 3), None
+    yield 're.match/view(0, 256)', best_of(run_view, number, 3), None
+
+
+def bench_slicing(quick):
+    number = 10000 if quick else 100000
+    buf = filled_buffer(True)
+    raw = bytearray(str(buf).encode())
+
+    def run_slice(number):
+        for _ in range(number):
+            buf[1000:1100]
+
+    def run_wrapped(number):
+        # crosses the end of internal buffer
+        middle = HAYSTACK // 2
+        for _ in range(number):
+            buf[middle - 50:middle + 50]
+
+    def run_bytearray(number):
+        for _ in range(number):
+            raw[1000:1100]
+
+    yield 'slice/CircularBuffer', best_of(run_slice, number, 3), None
+    yield 'slice/CircularBuffer/wrapping', best_of(run_wrapped, number, 3), \
+        None
+    yield 'slice/bytearray', best_of(run_bytearray, number, 3), None
+
+
+def bench_pool(quick):
+    number = 10000 if quick else 100000
+
+    def run_create(number):
+        for _ in range(number):
+            CircularBuffer(8192).write(b'x')
+
+    pool = BufferPool(8192)
+
+    def run_pool(number):
+        acquire = pool.acquire
+        release = pool.release
+        for _ in range(number):
+            buf = acquire()
+            buf.write(b'x')
+            release(buf)
+
+    yield 'connection/CircularBuffer(8192)', best_of(run_create, number, 3), \
+        None
+    yield 'connection/BufferPool(8192)', best_of(run_pool, number, 3), None
+
+
+BENCHMARKS = [
+    bench_throughput,
+    bench_search,
+    bench_make_contiguous,
+    bench_regex,
+    bench_slicing,
+    bench_pool,
+]
+
+
+def format_rate(rate):
+    if rate is None:
+        return ''
+    for unit in ('B/s', 'KB/s', 'MB/s', 'GB/s'):
+        if rate < 1000:
+            return '%7.1f %s' % (rate, unit)
+        rate /= 1000.
+    return '%7.1f TB/s' % rate
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('group', nargs='?', default='',
+                        help='only run groups containing this text: '
+                        'throughput, search, make_contiguous, regex, slicing, '
+                        'pool')
+    parser.add_argument('--json', help='save results into this file')
+    parser.add_argument('--compare', help='previous results to compare with')
+    parser.add_argument('--quick', action='store_true',
+                        help='fewer iterations, for a smoke test')
+    args = parser.parse_args()
+
+    previous = {}
+    if args.compare:
+        with open(args.compare) as f:
+            previous = json.load(f)['results']
+
+    results = {}
+    for benchmark in BENCHMARKS:
+        if args.group not in benchmark.__name__:
+            continue
+        for label, seconds, rate in benchmark(args.quick):
+            results[label] = {'seconds': seconds, 'bytes_per_second': rate}
+
+            line = '%-44s %12.1f ns %16s' % (label, seconds * 1e9,
+                                               format_rate(rate))
+            if label in previous:
+                line += '  %5.2fx' % (previous[label]['seconds'] / seconds)
+            print(line)
+            sys.stdout.flush()
+
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump({
+                'python': platform.python_version(),
+                'machine': platform.machine(),
+                'results': results,
+            }, f, indent=2, sort_keys=True)
+
+
+if __name__ == '__main__':
+    main()
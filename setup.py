@@ -5,11 +5,20 @@ c_lib = Extension(
     'circularbuffer',
     sources=[
         'src/circular_buffer.c',
+        'src/arguments.c',
         'src/base.c',
         'src/mapping.c',
+        'src/matcher.c',
         'src/methods.c',
+        'src/search.c',
         'src/sequence.c',
         'src/buffer.c',
+        'src/export.c',
+        'src/fdio.c',
+        'src/pool.c',
+        'src/pump.c',
+        'src/records.c',
+        'src/storage.c',
     ],
     include_dirs=['src'],
 )
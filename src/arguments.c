@@ -0,0 +1,159 @@
+#define PY_SSIZE_T_CLEAN
+#include "arguments.h"
+
+
+/*
+ * Position of keyword in kwlist, or -1.
+ */
+static Py_ssize_t keyword_index(PyObject* key, char** kwlist)
+{
+    for (Py_ssize_t i = 0; kwlist[i]; i++)
+    {
+#if PY_MAJOR_VERSION < 3
+        if (PyString_Check(key) && strcmp(PyString_AS_STRING(key), kwlist[i])
+                == 0)
+#else
+        if (PyUnicode_Check(key)
+                && PyUnicode_CompareWithASCIIString(key, kwlist[i]) == 0)
+#endif
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+
+static int set_keyword(const char* name, char** kwlist, PyObject** values,
+        PyObject* key, PyObject* value)
+{
+    Py_ssize_t pos = keyword_index(key, kwlist);
+    if (pos < 0)
+    {
+        PyErr_Format(PyExc_TypeError, "%s() got an unexpected keyword "
+                "argument", name);
+        return -1;
+    }
+    else if (values[pos])
+    {
+        PyErr_Format(PyExc_TypeError, "%s() got multiple values for argument "
+                "'%s'", name, kwlist[pos]);
+        return -1;
+    }
+    values[pos] = value;
+    return 0;
+}
+
+
+/*
+ * Sort positional and keyword arguments by kwlist, without converting them.
+ * Values are borrowed references.
+ */
+int circularbuffer_unpack_arguments(CIRCULARBUFFER_FAST_PARAMETERS,
+        const char* name, char** kwlist, Py_ssize_t required,
+        PyObject** values)
+{
+    Py_ssize_t size = 0;
+    while (kwlist[size])
+    {
+        values[size++] = NULL;
+    }
+
+#ifdef CIRCULARBUFFER_HAVE_FASTCALL
+    Py_ssize_t positional = nargs;
+#else
+    Py_ssize_t positional = PyTuple_GET_SIZE(args);
+#endif
+    if (positional > size)
+    {
+        PyErr_Format(PyExc_TypeError, "%s() takes at most %zd arguments "
+                "(%zd given)", name, size, positional);
+        return -1;
+    }
+
+#ifdef CIRCULARBUFFER_HAVE_FASTCALL
+    for (Py_ssize_t i = 0; i < nargs; i++)
+    {
+        values[i] = args[i];
+    }
+    if (kwnames)
+    {
+        for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(kwnames); i++)
+        {
+            if (set_keyword(name, kwlist, values,
+                    PyTuple_GET_ITEM(kwnames, i), args[nargs + i]))
+            {
+                return -1;
+            }
+        }
+    }
+#else
+    for (Py_ssize_t i = 0; i < positional; i++)
+    {
+        values[i] = PyTuple_GET_ITEM(args, i);
+    }
+    if (kwargs)
+    {
+        Py_ssize_t pos = 0;
+        PyObject* key;
+        PyObject* value;
+
+        while (PyDict_Next(kwargs, &pos, &key, &value))
+        {
+            if (set_keyword(name, kwlist, values, key, value))
+            {
+                return -1;
+            }
+        }
+    }
+#endif
+
+    for (Py_ssize_t i = 0; i < required; i++)
+    {
+        if (values[i] == NULL)
+        {
+            PyErr_Format(PyExc_TypeError, "%s() missing required argument "
+                    "'%s' (pos %zd)", name, kwlist[i], i + 1);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ * Convert an integer argument, like the "n" format unit.
+ */
+int circularbuffer_size_argument(PyObject* value, Py_ssize_t* result)
+{
+    if (value == NULL)
+    {
+        return 0;
+    }
+
+    Py_ssize_t size = PyNumber_AsSsize_t(value, PyExc_OverflowError);
+    if (size == -1 && PyErr_Occurred())
+    {
+        return -1;
+    }
+    *result = size;
+    return 0;
+}
+
+
+/*
+ * Get bytes argument without copying, like the "y#" format unit for bytes.
+ */
+int circularbuffer_bytes_argument(PyObject* value, const char** data,
+        Py_ssize_t* length)
+{
+    if (!PyBytes_Check(value))
+    {
+        PyErr_Format(PyExc_TypeError, "a bytes object is required, not "
+                "'%.100s'", Py_TYPE(value)->tp_name);
+        return -1;
+    }
+    *data = PyBytes_AS_STRING(value);
+    *length = PyBytes_GET_SIZE(value);
+    return 0;
+}
@@ -0,0 +1,35 @@
+#ifndef CIRCULAR_BUFFER_ARGUMENTS_H
+#define CIRCULAR_BUFFER_ARGUMENTS_H
+
+#include "base.h"
+
+// hot methods skip building argument tuples where vectorcall is available
+#if PY_VERSION_HEX >= 0x03070000
+    #define CIRCULARBUFFER_HAVE_FASTCALL
+#endif
+
+#ifdef CIRCULARBUFFER_HAVE_FASTCALL
+    #define CIRCULARBUFFER_FAST_PARAMETERS \
+            PyObject* const* args, Py_ssize_t nargs, PyObject* kwnames
+    #define CIRCULARBUFFER_FAST_ARGUMENTS args, nargs, kwnames
+    #define CIRCULARBUFFER_FAST_FLAGS (METH_FASTCALL | METH_KEYWORDS)
+#else
+    #define CIRCULARBUFFER_FAST_PARAMETERS PyObject* args, PyObject* kwargs
+    #define CIRCULARBUFFER_FAST_ARGUMENTS args, kwargs
+    #define CIRCULARBUFFER_FAST_FLAGS (METH_VARARGS | METH_KEYWORDS)
+#endif
+
+/* helper functions */
+
+// sort arguments into values, in the order of kwlist, missing ones are NULL
+int circularbuffer_unpack_arguments(CIRCULARBUFFER_FAST_PARAMETERS,
+        const char* name, char** kwlist, Py_ssize_t required,
+        PyObject** values);
+
+// leave result as it is for missing arguments
+int circularbuffer_size_argument(PyObject* value, Py_ssize_t* result);
+
+int circularbuffer_bytes_argument(PyObject* value, const char** data,
+        Py_ssize_t* length);
+
+#endif
@@ -1,12 +1,44 @@
 #define PY_SSIZE_T_CLEAN
 #include "base.h"
+#include "pump.h"
+#include "search.h"
+#include "storage.h"
+
+/*
+ * Raise ReservedError or RealignmentError, and count it.
+ */
+void circularbuffer_raise(CircularBuffer* self, PyObject* error,
+        const char* message)
+{
+    if (error == ReservedError)
+    {
+        self->stats.reserved_errors++;
+    }
+    else
+    {
+        self->stats.realignment_errors++;
+    }
+    PyErr_SetString(error, message);
+}
+
+
+/*
+ * Zero all counters.
+ */
+void circularbuffer_stats_reset(CircularBuffer* self)
+{
+    memset(&self->read_stats, 0, sizeof(self->read_stats));
+    memset(&self->write_stats, 0, sizeof(self->write_stats));
+    memset(&self->stats, 0, sizeof(self->stats));
+}
+
 
 /*
  * Get read pointer.
  */
 const char* circularbuffer_readptr(CircularBuffer* self)
 {
-    return (const char*) &self->raw[self->read];
+    return (const char*) &self->raw[CIRCULARBUFFER_READ_INDEX(self)];
 }
 
 
@@ -16,9 +48,10 @@ const char* circularbuffer_readptr(CircularBuffer* self)
 Py_ssize_t circularbuffer_forward_length(CircularBuffer* self,
         Py_ssize_t start)
 {
-    if (self->write >= start)
+    Py_ssize_t write = CIRCULARBUFFER_WRITE_INDEX(self);
+    if (write >= start)
     {
-        return self->write - start;
+        return write - start;
     }
     else
     {
@@ -32,12 +65,16 @@ Py_ssize_t circularbuffer_forward_length(CircularBuffer* self,
  */
 Py_ssize_t circularbuffer_total_length(CircularBuffer* self)
 {
-    Py_ssize_t len = circularbuffer_forward_length(self, self->read);
-    if (self->write < self->read)
+    Py_ssize_t read = CIRCULARBUFFER_READ_INDEX(self);
+    Py_ssize_t write = CIRCULARBUFFER_WRITE_INDEX(self);
+    if (write >= read)
+    {
+        return write - read;
+    }
+    else
     {
-        len += circularbuffer_forward_length(self, 0);
+        return self->allocated_before_resize - read + 1 + write;
     }
-    return len;
 }
 
 
@@ -46,17 +83,20 @@ Py_ssize_t circularbuffer_total_length(CircularBuffer* self)
  */
 Py_ssize_t circularbuffer_forward_available(CircularBuffer* self)
 {
-    if (self->write == self->allocated + 1)
+    Py_ssize_t read = CIRCULARBUFFER_READ_INDEX(self);
+    Py_ssize_t write = CIRCULARBUFFER_WRITE_INDEX(self);
+    if (write == self->allocated + 1)
     {
-        return self->read ? self->read - 1 : 0;
+        return read ? read - 1 : 0;
     }
-    else if (self->write < self->read)
+    else if (write < read)
     {
-        return self->read - self->write - 1;
+        return read - write - 1;
     }
     else
     {
-        return self->allocated - self->write + 1;
+        // the slot before read is always left empty
+        return self->allocated - write + (read ? 1 : 0);
     }
 }
 
@@ -66,13 +106,15 @@ Py_ssize_t circularbuffer_forward_available(CircularBuffer* self)
  */
 Py_ssize_t circularbuffer_total_available(CircularBuffer* self)
 {
-    if (self->write < self->read)
+    Py_ssize_t read = CIRCULARBUFFER_READ_INDEX(self);
+    Py_ssize_t write = CIRCULARBUFFER_WRITE_INDEX(self);
+    if (write < read)
     {
-        return self->read - self->write - 1;
+        return read - write - 1;
     }
     else
     {
-        return self->allocated - (self->write - self->read);
+        return self->allocated - (write - read);
     }
 }
 
@@ -91,15 +133,75 @@ Py_ssize_t circularbuffer_translated_position(CircularBuffer* self,
     {
         return -1;
     }
-    Py_ssize_t translated_pos = self->read + pos;
+    Py_ssize_t translated_pos = CIRCULARBUFFER_READ_INDEX(self) + pos;
     if (translated_pos > self->allocated_before_resize)
     {
-        translated_pos -= self->allocated_before_resize;
+        translated_pos -= self->allocated_before_resize + 1;
     }
     return translated_pos;
 }
 
 
+/*
+ * Locate stored data as at most two memory segments.
+ * Returns the number of segments used, mirrored storage only needs one.
+ */
+int circularbuffer_data_segments(CircularBuffer* self, Py_ssize_t start,
+        Py_ssize_t size, CircularBufferSegment segments[2])
+{
+    if (size <= 0)
+    {
+        return 0;
+    }
+
+    start = circularbuffer_translated_position(self, start);
+    Py_ssize_t avail = circularbuffer_forward_length(self, start);
+
+    segments[0].ptr = &self->raw[start];
+    if (avail >= size || self->storage == CIRCULARBUFFER_STORAGE_MIRROR)
+    {
+        segments[0].len = size;
+        return 1;
+    }
+    segments[0].len = avail;
+    segments[1].ptr = self->raw;
+    segments[1].len = size - avail;
+    return 2;
+}
+
+
+/*
+ * Locate free space as at most two memory segments.
+ * Returns the number of segments used, mirrored storage only needs one.
+ */
+int circularbuffer_free_segments(CircularBuffer* self, Py_ssize_t size,
+        CircularBufferSegment segments[2])
+{
+    Py_ssize_t total = circularbuffer_total_available(self);
+    if (size < 0 || size > total)
+    {
+        size = total;
+    }
+    if (size <= 0)
+    {
+        return 0;
+    }
+
+    Py_ssize_t avail = circularbuffer_forward_available(self);
+
+    segments[0].ptr = &self->raw[CIRCULARBUFFER_WRITE_INDEX(self)];
+    if (avail >= size || self->storage == CIRCULARBUFFER_STORAGE_MIRROR)
+    {
+        segments[0].len = size;
+        return 1;
+    }
+    segments[0].len = avail;
+    segments[1].ptr = self->raw;
+    segments[1].len = size - avail;
+    return 2;
+}
+
+
 /*
  * Get partial content.
  * May alter internal buffer during the course of the function.
@@ -117,95 +219,237 @@ PyObject* circularbuffer_peek_partial(CircularBuffer* self,
 
     len = end - start;
 
-    start = circularbuffer_translated_position(self, start);
-    Py_ssize_t avail = circularbuffer_forward_length(self, start);
+    // copy straight into the new bytes object
+    PyObject *result = PyBytes_FromStringAndSize(NULL, len);
+    if (result)
+    {
+        circularbuffer_copy(self, start, PyBytes_AS_STRING(result), len);
+    }
+    return result;
+}
 
-    char *tmp = (char*) PyMem_Malloc(len);
-    char *write = tmp;
 
-    if (avail < len)
+/*
+ * Copy stored data into memory owned by someone else.
+ */
+void circularbuffer_copy(CircularBuffer* self, Py_ssize_t start, char* dest,
+        Py_ssize_t size)
+{
+    CircularBufferSegment segments[2];
+    int count = circularbuffer_data_segments(self, start, size, segments);
+
+    if (self->spsc && size >= CIRCULARBUFFER_NOGIL_SIZE)
     {
-        memcpy(write, &self->raw[start], avail);
-        memcpy(write + avail, self->raw, len - avail);
+        // let the producer run meanwhile, but keep the data where it is
+        self->read_write_lock++;
+        Py_BEGIN_ALLOW_THREADS
+        for (int i = 0; i < count; i++)
+        {
+            memcpy(dest, segments[i].ptr, segments[i].len);
+            dest += segments[i].len;
+        }
+        Py_END_ALLOW_THREADS
+        self->read_write_lock--;
+        return;
     }
-    else
+
+    for (int i = 0; i < count; i++)
     {
-        memcpy(write, &self->raw[start], len);
+        memcpy(dest, segments[i].ptr, segments[i].len);
+        dest += segments[i].len;
     }
+}
 
-    PyObject *result = Py_BuildValue(STR_FORMAT_BYTE, tmp, len);
-    PyMem_Free(tmp);
-    return result;
+
+/*
+ * Move write pointer forward over data put into free space.
+ */
+void circularbuffer_produce(CircularBuffer* self, Py_ssize_t size)
+{
+    Py_ssize_t write = CIRCULARBUFFER_WRITE_INDEX(self) + size;
+    if (write > self->allocated)
+    {
+        write -= self->allocated + 1;
+    }
+    self->raw[write] = 0;
+    // publish the data to the consumer
+    CIRCULARBUFFER_STORE_RELEASE(self->write, write);
+    if (self->shared)
+    {
+        CIRCULARBUFFER_STORE_RELEASE(self->shared->write, write);
+    }
+
+    Py_ssize_t len = circularbuffer_total_length(self);
+    if (len > self->write_stats.high_watermark)
+    {
+        self->write_stats.high_watermark = len;
+    }
+    self->write_stats.bytes_written += size;
 }
 
 
 /*
- * Make the internal buffer's data contiguous, from two segments into one.
+ * Move read pointer forward, size must not exceed stored data.
  */
-int circularbuffer_make_contiguous(CircularBuffer* self)
+void circularbuffer_consume(CircularBuffer* self, Py_ssize_t size)
 {
-    if (self->write >= self->read)
+    self->scan_cursor = size < self->scan_cursor ? self->scan_cursor - size
+            : 0;
+
+    Py_ssize_t read = CIRCULARBUFFER_READ_INDEX(self) + size;
+    if (read > self->allocated_before_resize)
     {
-        return 0;
+        read -= self->allocated_before_resize + 1;
+        // past the old end, space added by resize() becomes usable
+        self->allocated_before_resize = self->allocated;
     }
-    else if (self->write_lock || self->read_write_lock)
+    // hand the space back to the producer
+    CIRCULARBUFFER_STORE_RELEASE(self->read, read);
+    if (self->shared)
     {
-        // trying to reallign internal buffer while it was being used
-        PyErr_SetString(ReservedError, "The internal buffer cannot be modified "
-                "at the moment.");
+        CIRCULARBUFFER_STORE_RELEASE(self->shared->read, read);
+    }
 
-        return -1;
+    self->read_stats.bytes_read += size;
+    self->read_stats.reads++;
+
+    if (self->pump)
+    {
+        circularbuffer_pump_consumed(self);
     }
-    self->read_lock++;
-    self->read_write_lock++;
-    self->write_lock++;
+    else if (self->elastic && read == CIRCULARBUFFER_WRITE_INDEX(self))
+    {
+        circularbuffer_storage_idle(self);
+    }
+}
 
-    // temporary storage, allocate half of the allocated
-    Py_ssize_t half_size = (self->allocated_before_resize - 1) / 2 + 1;
-    Py_ssize_t size = self->write < half_size ? self->write : half_size;
 
-    char* tmp_raw = PyMem_Malloc(size);
-    if (tmp_raw == NULL)
+/*
+ * Swap two blocks of equal size which do not overlap, a scratch sized piece
+ * at a time.
+ */
+static void swap_blocks(char* a, char* b, Py_ssize_t size)
+{
+    char scratch[CIRCULARBUFFER_SCRATCH_SIZE];
+
+    while (size)
     {
-        PyErr_NoMemory();
-        self->write_lock--;
-        self->read_write_lock--;
-        self->read_lock--;
-        return -1;
+        Py_ssize_t count = size > CIRCULARBUFFER_SCRATCH_SIZE
+                ? CIRCULARBUFFER_SCRATCH_SIZE : size;
+
+        memcpy(scratch, a, count);
+        memcpy(a, b, count);
+        memcpy(b, scratch, count);
+        a += count;
+        b += count;
+        size -= count;
     }
-    memcpy(tmp_raw, self->raw, size);
+}
 
-    // copy the first segment
-    char* write_ptr = self->raw;
-    size = circularbuffer_forward_length(self, self->read);
-    memmove(write_ptr, &self->raw[self->read], size);
-    write_ptr += size;
 
-    // copy the last segment (if the second segment was larger then half)
-    if (self->write > half_size)
+/*
+ * Rotate data in place so that its first left bytes move after the right
+ * bytes following them, by swapping blocks (Gries-Mills).
+ */
+static void rotate(char* data, Py_ssize_t left, Py_ssize_t right)
+{
+    char scratch[CIRCULARBUFFER_SCRATCH_SIZE];
+
+    while (left && right)
     {
-        size = circularbuffer_forward_length(self, half_size);
-        memcpy(write_ptr + half_size, self->raw + half_size, size);
-        size = half_size;
+        if (left <= CIRCULARBUFFER_SCRATCH_SIZE)
+        {
+            // small side fits aside, one pass over the rest
+            memcpy(scratch, data, left);
+            memmove(data, data + left, right);
+            memcpy(data + right, scratch, left);
+            return;
+        }
+        else if (right <= CIRCULARBUFFER_SCRATCH_SIZE)
+        {
+            memcpy(scratch, data + left, right);
+            memmove(data + right, data, left);
+            memcpy(data, scratch, right);
+            return;
+        }
+        else if (left <= right)
+        {
+            // left block is in place at the end, rotate the rest of right
+            swap_blocks(data, data + right, left);
+            right -= left;
+        }
+        else
+        {
+            // right block is in place at the start
+            swap_blocks(data, data + left, right);
+            data += right;
+            left -= right;
+        }
     }
-    else
+}
+
+
+/*
+ * Make the internal buffer's data contiguous, from two segments into one.
+ * Data is rotated in place, no temporary buffer is needed.
+ */
+int circularbuffer_make_contiguous(CircularBuffer* self)
+{
+    Py_ssize_t read = CIRCULARBUFFER_READ_INDEX(self);
+    Py_ssize_t write = CIRCULARBUFFER_WRITE_INDEX(self);
+
+    if (read == write)
     {
-        size = circularbuffer_forward_length(self, 0);
+        // empty, start over from the beginning unless someone points there
+        if (read && !self->spsc && !self->write_lock
+                && !self->read_write_lock)
+        {
+            self->read = 0;
+            self->write = 0;
+            self->reserved = 0;
+            self->raw[0] = 0;
+            self->allocated_before_resize = self->allocated;
+        }
+        return 0;
     }
+    else if (write > read || self->storage == CIRCULARBUFFER_STORAGE_MIRROR)
+    {
+        // mirrored storage is contiguous in virtual memory already
+        return 0;
+    }
+    else if (self->spsc)
+    {
+        circularbuffer_raise(self, ReservedError, "The internal buffer of "
+                "single-producer single-consumer buffer cannot be realigned.");
 
-    // copy the second segment
-    memcpy(write_ptr, tmp_raw, size);
-    PyMem_Free(tmp_raw);
+        return -1;
+    }
+    else if (self->write_lock || self->read_write_lock)
+    {
+        // trying to reallign internal buffer while it was being used
+        circularbuffer_raise(self, ReservedError, "The internal buffer cannot "
+                "be modified at the moment.");
+
+        return -1;
+    }
+    self->reserved = 0;
+
+    // first segment at the end, second one at the start
+    Py_ssize_t first = circularbuffer_forward_length(self, read);
+    Py_ssize_t second = write;
+    Py_ssize_t size = first + second;
+
+    // close the gap, then swap the segments
+    memmove(&self->raw[second], &self->raw[read], first);
+    rotate(self->raw, second, first);
 
-    size = circularbuffer_total_length(self);
     self->raw[size] = 0;
     self->write = size;
     self->read = 0;
     self->allocated_before_resize = self->allocated;
 
-    self->write_lock--;
-    self->read_write_lock--;
-    self->read_lock--;
+    self->stats.realignments++;
+    self->stats.realigned_bytes += size;
     return 0;
 }
 
@@ -238,7 +482,6 @@ Py_ssize_t circularbuffer_find(CircularBuffer *self, const char* search,
         Py_ssize_t search_len, Py_ssize_t start, Py_ssize_t end)
 {
     Py_ssize_t len = circularbuffer_total_length(self);
-    Py_ssize_t index = start + 1;
 
     circularbuffer_parse_slice_notation(self, len, &start, &end);
 
@@ -247,49 +490,27 @@ Py_ssize_t circularbuffer_find(CircularBuffer *self, const char* search,
         return -1;
     }
 
-    start = circularbuffer_translated_position(self, start);
-    end = circularbuffer_translated_position(self, end);
+    CircularBufferSegment segments[2];
+    int count = circularbuffer_data_segments(self, start, end - start,
+            segments);
 
-    const char* psearch = search;
-    const char* psearch_end = psearch + search_len;
+    Py_ssize_t found;
 
-    const char* pread = &self->raw[start];
-    const char* pread_half_end;
-    if (end < start)
+    if (self->spsc && end - start >= CIRCULARBUFFER_NOGIL_SIZE)
     {
-        pread_half_end = self->raw + self->allocated_before_resize;
+        // let the producer run meanwhile, but keep the data where it is
+        self->read_write_lock++;
+        Py_BEGIN_ALLOW_THREADS
+        found = circularbuffer_search_segments(segments, count, 0, search,
+                search_len);
+        Py_END_ALLOW_THREADS
+        self->read_write_lock--;
     }
     else
     {
-        pread_half_end = self->raw + end;
-    }
-
-    while (pread < pread_half_end)
-    {
-        psearch = pread[0] == psearch[0] ? psearch + 1 : search;
-        if (psearch == psearch_end)
-        {
-            return index - search_len;
-        }
-        pread += 1;
-        index += 1;
-    }
-    if (end < start)
-    {
-        pread = self->raw;
-        pread_half_end = self->raw + end;
-
-        while (pread < pread_half_end)
-        {
-            psearch = pread[0] == psearch[0] ? psearch + 1 : search;
-            if (psearch == psearch_end)
-            {
-                return index - search_len;
-            }
-            pread += 1;
-            index += 1;
-        }
+        found = circularbuffer_search_segments(segments, count, 0, search,
+                search_len);
     }
 
-    return -1;
+    return found < 0 ? found : start + found;
 }
@@ -13,45 +13,184 @@
 
 #if PY_MAJOR_VERSION < 3
     #define STR_FORMAT_BYTE "s#"
+    #define STR_FORMAT_BUFFER "s*"
 #else
     #define STR_FORMAT_BYTE "y#"
+    #define STR_FORMAT_BUFFER "y*"
 #endif
 
 #define REPR_LENGTH 64
 
+// copies and searches this large let other threads run, with spsc
+#define CIRCULARBUFFER_NOGIL_SIZE 16384
+
+// keep producer and consumer state apart
+#define CIRCULARBUFFER_CACHE_LINE 64
+
+// stack space used to move data around in place
+#define CIRCULARBUFFER_SCRATCH_SIZE 4096
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define CIRCULARBUFFER_LOAD_ACQUIRE(var) \
+            __atomic_load_n(&(var), __ATOMIC_ACQUIRE)
+    #define CIRCULARBUFFER_STORE_RELEASE(var, value) \
+            __atomic_store_n(&(var), (value), __ATOMIC_RELEASE)
+#else
+    // aligned loads and stores are atomic on the platforms msvc targets
+    #define CIRCULARBUFFER_LOAD_ACQUIRE(var) \
+            (*(volatile Py_ssize_t*) &(var))
+    #define CIRCULARBUFFER_STORE_RELEASE(var, value) \
+            (*(volatile Py_ssize_t*) &(var) = (value))
+#endif
+
+// indices of a ring shared between processes live in shared memory
+#define CIRCULARBUFFER_READ_INDEX(self) ((self)->shared \
+        ? CIRCULARBUFFER_LOAD_ACQUIRE((self)->shared->read) \
+        : CIRCULARBUFFER_LOAD_ACQUIRE((self)->read))
+#define CIRCULARBUFFER_WRITE_INDEX(self) ((self)->shared \
+        ? CIRCULARBUFFER_LOAD_ACQUIRE((self)->shared->write) \
+        : CIRCULARBUFFER_LOAD_ACQUIRE((self)->write))
+
 // see: http://stackoverflow.com/a/17996915
 #define QUOTE(...) #__VA_ARGS__
 
+/* storage kinds */
+
+// plain heap allocation
+#define CIRCULARBUFFER_STORAGE_HEAP 0
+// memory mapped twice back to back, wrapped data is always contiguous
+#define CIRCULARBUFFER_STORAGE_MIRROR 1
+// anonymous memory mapping
+#define CIRCULARBUFFER_STORAGE_MMAP 2
+// anonymous memory mapping backed by huge pages, when the system has them
+#define CIRCULARBUFFER_STORAGE_HUGEPAGE 3
+// named shared memory, with the indices in front of the data
+#define CIRCULARBUFFER_STORAGE_SHARED 4
+
+#define CIRCULARBUFFER_SHARED_MAGIC "CBRING1"
+
 /* objects */
 
+// kept by whoever moves the read pointer
+typedef struct {
+    unsigned long long bytes_read;
+    unsigned long long reads;
+} CircularBufferReadStats;
+
+// kept by whoever moves the write pointer
+typedef struct {
+    unsigned long long bytes_written;
+    unsigned long long writes;
+    unsigned long long short_writes;
+    unsigned long long bytes_refused;
+    Py_ssize_t high_watermark;
+} CircularBufferWriteStats;
+
+// rare events, always with the GIL
+typedef struct {
+    unsigned long long realignments;
+    unsigned long long realigned_bytes;
+    unsigned long long reserved_errors;
+    unsigned long long realignment_errors;
+    unsigned long long resizes;
+} CircularBufferStats;
+
+// start of shared memory segment, internal buffer follows
+typedef struct {
+    char magic[8];
+    Py_ssize_t allocated;
+    char read_padding[CIRCULARBUFFER_CACHE_LINE - 8 - sizeof(Py_ssize_t)];
+    Py_ssize_t read;
+    char write_padding[CIRCULARBUFFER_CACHE_LINE - sizeof(Py_ssize_t)];
+    Py_ssize_t write;
+    char end_padding[CIRCULARBUFFER_CACHE_LINE - sizeof(Py_ssize_t)];
+} CircularBufferSharedHeader;
+
 typedef struct {
     PyObject_HEAD
     // type specific fields
     char* raw;
+    int storage;
+    // start of the heap allocation, raw is aligned to a cache line within it
+    char* block;
+    // length and page size of the memory mapping behind raw
+    Py_ssize_t mapped;
+    Py_ssize_t page;
+    // header of shared memory segment, or NULL
+    CircularBufferSharedHeader* shared;
+    // name to unlink, when this buffer has created the segment
+    char* shared_name;
+    // one thread writes, another one reads, without the GIL for large copies
+    int spsc;
+
+    // only the consumer moves read, only the producer moves write
+    char read_padding[CIRCULARBUFFER_CACHE_LINE];
     Py_ssize_t read;
+    CircularBufferReadStats read_stats;
+    char write_padding[CIRCULARBUFFER_CACHE_LINE];
     Py_ssize_t write;
+    CircularBufferWriteStats write_stats;
+    char allocated_padding[CIRCULARBUFFER_CACHE_LINE];
+
     Py_ssize_t allocated;
     Py_ssize_t allocated_before_resize;
+    // size reported to the user, larger than allocated while elastic
+    // storage is released
+    Py_ssize_t capacity;
+    // allocate on demand, give memory back down to min_size once drained
+    int elastic;
+    Py_ssize_t min_size;
+    // write() grows internal buffer up to this size, or never when smaller
+    Py_ssize_t max_size;
+    // write() drops the oldest data rather than return a short count
+    int overwrite;
+    Py_ssize_t dropped;
 
     // read-only lock (rare, when restructuring internal buffer)
     int read_lock;
     // read and update-read-pointer lock (when buffer protocol is active)
-    char read_write_lock;
+    int read_write_lock;
 #if PY_MAJOR_VERSION < 3
-    char buffer_view_count;
+    int buffer_view_count;
 #endif
-    // write lock (rare, when restructuring internal buffer)
-    char write_lock;
+    // write lock (when restructuring internal buffer or a reservation is
+    // being filled)
+    int write_lock;
+    // size of free space handed out by reserve() and not committed yet
+    Py_ssize_t reserved;
+
+    // read_until() already searched everything before this index for
+    // scan_delimiter, write() leaves it alone
+    Py_ssize_t scan_cursor;
+    PyObject* scan_delimiter;
+
+    // native thread filling the buffer from a file descriptor, or NULL
+    struct CircularBufferPump* pump;
+
+    CircularBufferStats stats;
 } CircularBuffer;
 
 
+typedef struct {
+    char* ptr;
+    Py_ssize_t len;
+} CircularBufferSegment;
+
+
 /* custom errors */
 
 extern PyObject* RealignmentError;
 extern PyObject* ReservedError;
 
+extern PyTypeObject CircularBufferType;
+
 /* helper functions */
 
+void circularbuffer_raise(CircularBuffer* self, PyObject* error,
+        const char* message);
+
+void circularbuffer_stats_reset(CircularBuffer* self);
+
 const char* circularbuffer_readptr(CircularBuffer* self);
 
 Py_ssize_t circularbuffer_forward_length(CircularBuffer* self,
@@ -67,9 +206,22 @@ Py_ssize_t circularbuffer_translated_position(CircularBuffer* self,
 
 Py_ssize_t circularbuffer_write_available(CircularBuffer* self);
 
+int circularbuffer_data_segments(CircularBuffer* self, Py_ssize_t start,
+        Py_ssize_t size, CircularBufferSegment segments[2]);
+
+int circularbuffer_free_segments(CircularBuffer* self, Py_ssize_t size,
+        CircularBufferSegment segments[2]);
+
 PyObject* circularbuffer_peek_partial(CircularBuffer* self,
         Py_ssize_t start, Py_ssize_t size);
 
+void circularbuffer_copy(CircularBuffer* self, Py_ssize_t start, char* dest,
+        Py_ssize_t size);
+
+void circularbuffer_produce(CircularBuffer* self, Py_ssize_t size);
+
+void circularbuffer_consume(CircularBuffer* self, Py_ssize_t size);
+
 int circularbuffer_make_contiguous(CircularBuffer* self);
 
 void circularbuffer_parse_slice_notation(CircularBuffer *self, Py_ssize_t len,
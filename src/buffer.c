@@ -10,16 +10,16 @@ int CircularBuffer_py3_get_buffer(CircularBuffer* self,
         return -1;
     }
 
-    self->read_write_lock++;
-
     Py_ssize_t len = circularbuffer_total_length(self);
 
-    view->obj = (PyObject*) self;
-    view->len = len * sizeof(char);
-    view->format = "b";
-    view->buf = &self->raw[self->read];
+    if (PyBuffer_FillInfo(view, (PyObject*) self,
+            (void*) circularbuffer_readptr(self),
+            len * sizeof(char), 0, flags))
+    {
+        return -1;
+    }
 
-    Py_INCREF(self);
+    self->read_write_lock++;
     return 0;
 }
 
@@ -29,6 +29,8 @@ int CircularBuffer_py3_release_buffer(CircularBuffer* self,
 {
     //Py_DECREF(self);
     self->read_write_lock--;
+    // stored data may have been changed through the export
+    self->scan_cursor = 0;
     return 0;
 }
 
@@ -38,7 +40,7 @@ int CircularBuffer_py3_release_buffer(CircularBuffer* self,
 int CircularBuffer_py2_get_read_buffer(CircularBuffer* self, int segment,
         void** data)
 {
-    *data = (void*) &self->raw[self->read];
+    *data = (void*) circularbuffer_readptr(self);
     return circularbuffer_total_length(self);
 }
 
@@ -73,7 +75,7 @@ int CircularBuffer_py2_get_segcount(CircularBuffer* self, int* len)
 int CircularBuffer_py2_get_char_buffer(CircularBuffer* self, int segment,
         char** data)
 {
-    *data = &self->raw[self->read];
+    *data = (char*) circularbuffer_readptr(self);
     return circularbuffer_total_length(self);
 }
 
@@ -1,9 +1,15 @@
 #define PY_SSIZE_T_CLEAN
 #include "base.h"
 #include "mapping.h"
+#include "matcher.h"
 #include "methods.h"
+#include "pool.h"
+#include "search.h"
 #include "sequence.h"
 #include "buffer.h"
+#include "export.h"
+#include "pump.h"
+#include "storage.h"
 
 /* custom errors */
 
@@ -24,14 +30,32 @@ PyObject* CircularBuffer_create(PyTypeObject* type, PyObject* args,
     if (self)
     {
         self->raw = NULL;
+        self->storage = CIRCULARBUFFER_STORAGE_HEAP;
+        self->block = NULL;
+        self->mapped = 0;
+        self->page = 0;
+        self->shared = NULL;
+        self->shared_name = NULL;
+        self->spsc = 0;
         self->read = 0;
         self->write = 0;
         self->allocated = 0;
         self->allocated_before_resize = 0;
+        self->capacity = 0;
+        self->elastic = 0;
+        self->min_size = 0;
+        self->max_size = 0;
+        self->overwrite = 0;
+        self->dropped = 0;
 
         self->write_lock = 0;
         self->read_lock = 0;
         self->read_write_lock = 0;
+        self->reserved = 0;
+        self->scan_cursor = 0;
+        self->scan_delimiter = NULL;
+        self->pump = NULL;
+        circularbuffer_stats_reset(self);
 #if PY_MAJOR_VERSION < 3
         self->buffer_view_count = 0;
 #endif
@@ -44,33 +68,139 @@ PyObject* CircularBuffer_create(PyTypeObject* type, PyObject* args,
 int CircularBuffer_initialize(CircularBuffer* self, PyObject* args,
         PyObject* kwargs)
 {
-    static char* kwlist[] = {"size", NULL};
+    static char* kwlist[] = {"size", "mirror", "spsc", "max_size",
+            "overwrite", "allocator", "elastic", "min_size", "shared", "create",
+            NULL};
 
     Py_ssize_t size;
-
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n", kwlist, &size))
+    int mirror = 0;
+    int spsc = 0;
+    Py_ssize_t max_size = 0;
+    int overwrite = 0;
+    const char* allocator = "malloc";
+    int elastic = 0;
+    Py_ssize_t min_size = 0;
+    const char* shared = NULL;
+    int create = 0;
+    int storage;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|iinisinzi", kwlist,
+            &size, &mirror, &spsc, &max_size, &overwrite, &allocator,
+            &elastic, &min_size, &shared, &create))
     {
         // Exception already set by PyArg_ParseTuple
         return -1;
     }
+    else if (shared && (mirror || elastic || overwrite || max_size
+            || strcmp(allocator, "malloc") != 0))
+    {
+        // the other process could not follow
+        PyErr_SetString(PyExc_ValueError, "Shared buffer cannot be mirrored, "
+                "elastic, overwriting nor growing.");
+
+        return -1;
+    }
+    else if (shared && size < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "Size cannot be negative.");
+        return -1;
+    }
+    else if (elastic && (mirror || spsc))
+    {
+        // neither can move nor resize internal buffer on the fly
+        PyErr_SetString(PyExc_ValueError, "Elastic buffer cannot be mirrored "
+                "nor single-producer single-consumer one.");
+
+        return -1;
+    }
+    else if (min_size < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "Minimal size cannot be negative.");
+        return -1;
+    }
+    else if (spsc && overwrite)
+    {
+        // the producer would have to move the read pointer
+        PyErr_SetString(PyExc_ValueError, "Overwriting buffer cannot be "
+                "single-producer single-consumer one.");
+
+        return -1;
+    }
+    else if (strcmp(allocator, "malloc") == 0)
+    {
+        storage = mirror ? CIRCULARBUFFER_STORAGE_MIRROR
+                : CIRCULARBUFFER_STORAGE_HEAP;
+    }
+    else if (mirror)
+    {
+        PyErr_SetString(PyExc_ValueError, "Mirrored buffer cannot use another "
+                "allocator.");
+
+        return -1;
+    }
+    else if (strcmp(allocator, "mmap") == 0)
+    {
+        storage = CIRCULARBUFFER_STORAGE_MMAP;
+    }
+    else if (strcmp(allocator, "hugepage") == 0)
+    {
+        storage = CIRCULARBUFFER_STORAGE_HUGEPAGE;
+    }
+    else
+    {
+        PyErr_Format(PyExc_ValueError, "Unknown allocator '%.100s', expected "
+                "'malloc', 'mmap' or 'hugepage'.", allocator);
+        return -1;
+    }
 
-    self->raw = (char*) PyMem_Malloc(size + 2);
-    if (self->raw == NULL) {
-        PyErr_NoMemory();
+    // exported views and the pump still point into the old storage
+    if (self->read_lock || self->read_write_lock || self->write_lock
+            || self->reserved)
+    {
+        circularbuffer_raise(self, ReservedError, "The internal buffer cannot "
+                "be modified at the moment.");
         return -1;
     }
 
-    self->allocated = size;
-    self->allocated_before_resize = size;
-    self->raw[0] = 0;
-    self->raw[size + 1] = 0;
+    circularbuffer_pump_stop(self);
+    circularbuffer_storage_free(self);
+    self->storage = storage;
+    self->read = 0;
+    self->write = 0;
+    // one process writes, another one reads
+    self->spsc = spsc || shared;
+    self->max_size = max_size;
+    self->overwrite = overwrite;
+    self->dropped = 0;
+    self->scan_cursor = 0;
+    Py_CLEAR(self->scan_delimiter);
+    self->elastic = elastic;
+    self->min_size = min_size < size ? min_size : size;
+    circularbuffer_stats_reset(self);
+
+    if (shared)
+    {
+        if (circularbuffer_storage_share(self, shared, size, create))
+        {
+            return -1;
+        }
+        size = self->allocated;
+    }
+    else if (circularbuffer_storage_allocate(self, elastic ? self->min_size
+            : size))
+    {
+        return -1;
+    }
+    self->capacity = self->allocated > size ? self->allocated : size;
     return 0;
 }
 
 
 void CircularBuffer_destroy(CircularBuffer* self)
 {
-    PyMem_Free(self->raw);
+    circularbuffer_pump_stop(self);
+    circularbuffer_storage_free(self);
+    Py_XDECREF(self->scan_delimiter);
     Py_TYPE(self)->tp_free((PyObject*) self);
 }
 
@@ -101,14 +231,15 @@ PyObject* CircularBuffer_repr(CircularBuffer* self)
         write[count + 2] = '>';
     }
 
-    avail = circularbuffer_forward_length(self, self->read);
+    avail = circularbuffer_forward_length(self,
+            CIRCULARBUFFER_READ_INDEX(self));
     if (count <= avail)
     {
-        memcpy(write, &self->raw[self->read], count);
+        memcpy(write, circularbuffer_readptr(self), count);
     }
     else
     {
-        memcpy(write, &self->raw[self->read], avail);
+        memcpy(write, circularbuffer_readptr(self), avail);
         memcpy(write + avail, self->raw, count - avail);
     }
 
@@ -124,8 +255,9 @@ PyObject* CircularBuffer_str(CircularBuffer* self)
     char *tmp = (char*) PyMem_Malloc(len);
     char *write = tmp;
 
-    Py_ssize_t avail = circularbuffer_forward_length(self, self->read);
-    memcpy(write, &self->raw[self->read], avail);
+    Py_ssize_t avail = circularbuffer_forward_length(self,
+            CIRCULARBUFFER_READ_INDEX(self));
+    memcpy(write, circularbuffer_readptr(self), avail);
     if (avail < len)
     {
         memcpy(write + avail, self->raw, len - avail);
@@ -217,14 +349,27 @@ PyObject *module_init(void)
     #endif
     if (module == NULL) { return NULL; }
 
+    circularbuffer_search_init();
+
     // create new class
     if (PyType_Ready(&CircularBufferType) < 0) { return NULL; }
+    if (PyType_Ready(&CircularBufferExportType) < 0) { return NULL; }
+    if (PyType_Ready(&CircularBufferMatcherType) < 0) { return NULL; }
+    if (PyType_Ready(&CircularBufferPoolType) < 0) { return NULL; }
 
     // add class to module
     Py_INCREF(&CircularBufferType);
     PyModule_AddObject(module, "CircularBuffer",
                        (PyObject*) &CircularBufferType);
 
+    Py_INCREF(&CircularBufferMatcherType);
+    PyModule_AddObject(module, "Matcher",
+                       (PyObject*) &CircularBufferMatcherType);
+
+    Py_INCREF(&CircularBufferPoolType);
+    PyModule_AddObject(module, "BufferPool",
+                       (PyObject*) &CircularBufferPoolType);
+
     // create exceptions
     RealignmentError = PyErr_NewException("circularbuffer.RealignmentError",
             PyExc_RuntimeError, NULL);
@@ -0,0 +1,118 @@
+#define PY_SSIZE_T_CLEAN
+#include "export.h"
+
+/*
+ * Lock counter pinned by an export, read-only exports keep the data from
+ * being consumed, writable exports keep free space from being written.
+ */
+static int* export_lock(CircularBufferExport* self)
+{
+    return self->readonly ? &self->owner->read_write_lock
+            : &self->owner->write_lock;
+}
+
+
+int CircularBufferExport_get_buffer(CircularBufferExport* self,
+        Py_buffer* view, int flags)
+{
+    if (self->expired)
+    {
+        PyErr_SetString(PyExc_BufferError, "Exported memory was released.");
+        view->obj = NULL;
+        return -1;
+    }
+    if (PyBuffer_FillInfo(view, (PyObject*) self, self->buf, self->len,
+            self->readonly, flags))
+    {
+        return -1;
+    }
+
+    self->exports++;
+    (*export_lock(self))++;
+    return 0;
+}
+
+
+void CircularBufferExport_release_buffer(CircularBufferExport* self,
+        Py_buffer* view)
+{
+    (*export_lock(self))--;
+    if (--self->exports == 0)
+    {
+        // internal buffer may be moved from now on
+        self->expired = 1;
+    }
+}
+
+
+void CircularBufferExport_destroy(CircularBufferExport* self)
+{
+    Py_XDECREF(self->owner);
+    Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+
+PyBufferProcs CircularBufferExport_buffer[] = {{
+#if PY_MAJOR_VERSION < 3
+    0,                                                      // bf_getreadbuffer
+    0,                                                      // bf_getwritebuffer
+    0,                                                      // bf_getsegcount
+    0,                                                      // bf_getcharbuffer
+#endif
+    (getbufferproc) CircularBufferExport_get_buffer,        // bf_getbuffer
+    (releasebufferproc) CircularBufferExport_release_buffer,// bf_releasebuffer
+}};
+
+
+PyTypeObject CircularBufferExportType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "circularbuffer._Export",                  // tp_name
+    sizeof(CircularBufferExport),              // tp_basicsize
+    0,                                         // tp_itemsize
+    (destructor) CircularBufferExport_destroy, // tp_dealloc
+    0,                                         // tp_print (deprecated)
+    0,                                         // tp_getattr (deprecated)
+    0,                                         // tp_setattr (deprecated)
+    0,                                         // tp_compare
+    0,                                         // tp_repr
+    0,                                         // tp_as_number
+    0,                                         // tp_as_sequence
+    0,                                         // tp_as_mapping
+    0,                                         // tp_hash
+    0,                                         // tp_call
+    0,                                         // tp_str
+    0,                                         // tp_getattro
+    0,                                         // tp_setattro
+    CircularBufferExport_buffer,               // tp_as_buffer
+    Py_TPFLAGS_DEFAULT,                        // tp_flags
+    "Part of circular buffer's internal buffer", // tp_doc
+};
+
+
+/*
+ * Memoryview over part of the internal buffer, the lock counters stay pinned
+ * until the memoryview is released.
+ */
+PyObject* circularbuffer_export_memoryview(CircularBuffer* self, char* buf,
+        Py_ssize_t len, int readonly)
+{
+    CircularBufferExport* export = PyObject_New(CircularBufferExport,
+            &CircularBufferExportType);
+
+    if (export == NULL)
+    {
+        return NULL;
+    }
+
+    Py_INCREF(self);
+    export->owner = self;
+    export->buf = buf;
+    export->len = len;
+    export->readonly = readonly;
+    export->exports = 0;
+    export->expired = 0;
+
+    PyObject* result = PyMemoryView_FromObject((PyObject*) export);
+    Py_DECREF(export);
+    return result;
+}
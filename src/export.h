@@ -0,0 +1,27 @@
+#ifndef CIRCULAR_BUFFER_EXPORT_H
+#define CIRCULAR_BUFFER_EXPORT_H
+
+#include "base.h"
+
+/* objects */
+
+// exports part of the internal buffer, while pinning it with lock counters
+typedef struct {
+    PyObject_HEAD
+    CircularBuffer* owner;
+    char* buf;
+    Py_ssize_t len;
+    int readonly;
+    int exports;
+    // no more exports after the last one was released
+    int expired;
+} CircularBufferExport;
+
+extern PyTypeObject CircularBufferExportType;
+
+/* helper functions */
+
+PyObject* circularbuffer_export_memoryview(CircularBuffer* self, char* buf,
+        Py_ssize_t len, int readonly);
+
+#endif
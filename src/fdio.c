@@ -0,0 +1,233 @@
+#define PY_SSIZE_T_CLEAN
+#include "fdio.h"
+#include "storage.h"
+
+#include <errno.h>
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+
+/*
+ * Read into free space with one system call, without holding the GIL.
+ */
+static Py_ssize_t fd_read(int fd, CircularBufferSegment* segments, int count)
+{
+    Py_ssize_t result;
+
+    if (count <= 0)
+    {
+        return 0;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+#ifdef _WIN32
+    result = _read(fd, segments[0].ptr, (unsigned int) segments[0].len);
+#else
+    struct iovec iov[2];
+    for (int i = 0; i < count; i++)
+    {
+        iov[i].iov_base = segments[i].ptr;
+        iov[i].iov_len = segments[i].len;
+    }
+    result = readv(fd, iov, count);
+#endif
+    Py_END_ALLOW_THREADS
+
+    return result;
+}
+
+
+/*
+ * Write stored data with one system call, without holding the GIL.
+ */
+static Py_ssize_t fd_write(int fd, CircularBufferSegment* segments, int count)
+{
+    Py_ssize_t result;
+
+    if (count <= 0)
+    {
+        return 0;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+#ifdef _WIN32
+    result = _write(fd, segments[0].ptr, (unsigned int) segments[0].len);
+#else
+    struct iovec iov[2];
+    for (int i = 0; i < count; i++)
+    {
+        iov[i].iov_base = segments[i].ptr;
+        iov[i].iov_len = segments[i].len;
+    }
+    result = writev(fd, iov, count);
+#endif
+    Py_END_ALLOW_THREADS
+
+    return result;
+}
+
+
+const char CIRCULARBUFFER_FILL_FROM_FD_DOCSTRING[] = QUOTE(
+    CB.fill_from_fd(fd [,size]) -> int\n
+    \n
+    Read from file descriptor straight into internal buffer, with one
+    system call even if free space wraps around.\n
+    \n
+    :param fd: file descriptor, or object with fileno() method\n
+    :param size: maximum number of bytes to read, could be negative which
+                 means as much as fits\n
+    :returns: number of bytes read, 0 on end of file or if buffer is full\n
+    :raises OSError: reading failed, BlockingIOError for non-blocking file
+                     descriptor without data\n
+    :raises RealignmentError: internal buffer is being realign into one
+                              segment\n
+    :raises ReservedError: free space was reserved with CB.reserve()
+);
+
+PyObject* CircularBuffer_fill_from_fd(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs)
+{
+    static char* kwlist[] = {"fd", "size", NULL};
+
+    PyObject* file;
+    Py_ssize_t size = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|n", kwlist, &file,
+            &size))
+    {
+        return NULL;
+    }
+
+    int fd = PyObject_AsFileDescriptor(file);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    else if (self->write_lock)
+    {
+        circularbuffer_raise(self, RealignmentError, "This is rare, but "
+                "internal buffer temporarily not available.");
+
+        return NULL;
+    }
+    else if (self->reserved)
+    {
+        circularbuffer_raise(self, ReservedError, "Previous reservation was "
+                "not committed.");
+
+        return NULL;
+    }
+
+    else if (circularbuffer_storage_prepare(self, size))
+    {
+        return NULL;
+    }
+
+    CircularBufferSegment segments[2];
+    int count = circularbuffer_free_segments(self, size, segments);
+    if (count == 0)
+    {
+        return Py_BuildValue("n", (Py_ssize_t) 0);
+    }
+
+    Py_ssize_t result;
+
+    // other threads may run while we wait, keep them off the free space
+    self->write_lock++;
+    self->reserved = segments[0].len + (count > 1 ? segments[1].len : 0);
+    do
+    {
+        result = fd_read(fd, segments, count);
+    }
+    while (result < 0 && errno == EINTR && !PyErr_CheckSignals());
+    self->reserved = 0;
+    self->write_lock--;
+
+    if (result < 0)
+    {
+        return PyErr_Occurred() ? NULL : PyErr_SetFromErrno(PyExc_OSError);
+    }
+
+    circularbuffer_produce(self, result);
+    return Py_BuildValue("n", result);
+}
+
+
+const char CIRCULARBUFFER_DRAIN_TO_FD_DOCSTRING[] = QUOTE(
+    CB.drain_to_fd(fd [,size]) -> int\n
+    \n
+    Write stored data into file descriptor and remove what was written, with
+    one system call even if the data wraps around.\n
+    \n
+    :param fd: file descriptor, or object with fileno() method\n
+    :param size: maximum number of bytes to write, could be negative which
+                 means all of the data\n
+    :returns: number of bytes written\n
+    :raises OSError: writing failed, BlockingIOError for non-blocking file
+                     descriptor that is not ready\n
+    :raises ReservedError: someone uses buffer protocol
+);
+
+PyObject* CircularBuffer_drain_to_fd(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs)
+{
+    static char* kwlist[] = {"fd", "size", NULL};
+
+    PyObject* file;
+    Py_ssize_t size = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|n", kwlist, &file,
+            &size))
+    {
+        return NULL;
+    }
+
+    int fd = PyObject_AsFileDescriptor(file);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    else if (self->read_lock || self->read_write_lock)
+    {
+        circularbuffer_raise(self, ReservedError, "The internal buffer cannot "
+                "be modified at the moment.");
+
+        return NULL;
+    }
+
+    Py_ssize_t len = circularbuffer_total_length(self);
+    if (size < 0 || size > len)
+    {
+        size = len;
+    }
+
+    CircularBufferSegment segments[2];
+    int count = circularbuffer_data_segments(self, 0, size, segments);
+    if (count == 0)
+    {
+        return Py_BuildValue("n", (Py_ssize_t) 0);
+    }
+
+    Py_ssize_t result;
+
+    // other threads may run while we wait, keep them off the data
+    self->read_write_lock++;
+    do
+    {
+        result = fd_write(fd, segments, count);
+    }
+    while (result < 0 && errno == EINTR && !PyErr_CheckSignals());
+    self->read_write_lock--;
+
+    if (result < 0)
+    {
+        return PyErr_Occurred() ? NULL : PyErr_SetFromErrno(PyExc_OSError);
+    }
+
+    circularbuffer_consume(self, result);
+    return Py_BuildValue("n", result);
+}
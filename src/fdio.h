@@ -0,0 +1,15 @@
+#ifndef CIRCULAR_BUFFER_FDIO_H
+#define CIRCULAR_BUFFER_FDIO_H
+
+#include "base.h"
+
+PyObject* CircularBuffer_fill_from_fd(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs);
+
+PyObject* CircularBuffer_drain_to_fd(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs);
+
+extern const char CIRCULARBUFFER_FILL_FROM_FD_DOCSTRING[];
+extern const char CIRCULARBUFFER_DRAIN_TO_FD_DOCSTRING[];
+
+#endif
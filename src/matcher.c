@@ -0,0 +1,425 @@
+#define PY_SSIZE_T_CLEAN
+#include "matcher.h"
+#include <limits.h>
+
+/*
+ * Build the trie of all patterns, then turn it into a full transition table
+ * by following failure links breadth first.
+ */
+static int matcher_compile(CircularBufferMatcher* self)
+{
+    // states are int and the table holds 256 of them per state
+    Py_ssize_t limit = PY_SSIZE_T_MAX / (256 * sizeof(int));
+    if (limit > INT_MAX)
+    {
+        limit = INT_MAX;
+    }
+
+    Py_ssize_t size = 1;
+    for (Py_ssize_t i = 0; i < self->pattern_count; i++)
+    {
+        if (self->pattern_lengths[i] > limit - size)
+        {
+            PyErr_SetString(PyExc_ValueError, "Patterns are too long.");
+            return -1;
+        }
+        size += self->pattern_lengths[i];
+    }
+
+    self->transitions = (int*) PyMem_Malloc(size * 256 * sizeof(int));
+    self->outputs = (int*) PyMem_Malloc(size * sizeof(int));
+    self->output_links = (int*) PyMem_Malloc(size * sizeof(int));
+    int* failures = (int*) PyMem_Malloc(size * sizeof(int));
+    int* queue = (int*) PyMem_Malloc(size * sizeof(int));
+
+    if (self->transitions == NULL || self->outputs == NULL
+            || self->output_links == NULL || failures == NULL || queue == NULL)
+    {
+        PyMem_Free(failures);
+        PyMem_Free(queue);
+        // an uncompiled matcher is refused by the searches
+        PyMem_Free(self->transitions);
+        PyMem_Free(self->outputs);
+        PyMem_Free(self->output_links);
+        self->transitions = NULL;
+        self->outputs = NULL;
+        self->output_links = NULL;
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    for (Py_ssize_t i = 0; i < size * 256; i++)
+    {
+        self->transitions[i] = -1;
+    }
+    for (Py_ssize_t i = 0; i < size; i++)
+    {
+        self->outputs[i] = -1;
+        self->output_links[i] = -1;
+    }
+
+    // trie
+    self->state_count = 1;
+    for (Py_ssize_t i = 0; i < self->pattern_count; i++)
+    {
+        const unsigned char* pattern = (const unsigned char*)
+                PyBytes_AS_STRING(PyTuple_GET_ITEM(self->patterns, i));
+        int state = 0;
+
+        for (Py_ssize_t j = 0; j < self->pattern_lengths[i]; j++)
+        {
+            int* next = &self->transitions[state * 256 + pattern[j]];
+            if (*next < 0)
+            {
+                *next = (int) self->state_count++;
+            }
+            state = *next;
+        }
+        // duplicated patterns report the first one
+        if (self->outputs[state] < 0)
+        {
+            self->outputs[state] = (int) i;
+        }
+    }
+
+    // failure links
+    Py_ssize_t head = 0;
+    Py_ssize_t tail = 0;
+
+    for (int c = 0; c < 256; c++)
+    {
+        int next = self->transitions[c];
+        if (next < 0)
+        {
+            self->transitions[c] = 0;
+        }
+        else
+        {
+            failures[next] = 0;
+            queue[tail++] = next;
+        }
+    }
+    while (head < tail)
+    {
+        int state = queue[head++];
+        for (int c = 0; c < 256; c++)
+        {
+            int* next = &self->transitions[state * 256 + c];
+            int fallback = self->transitions[failures[state] * 256 + c];
+
+            if (*next < 0)
+            {
+                *next = fallback;
+            }
+            else
+            {
+                failures[*next] = fallback;
+                self->output_links[*next] = self->outputs[fallback] >= 0
+                        ? fallback : self->output_links[fallback];
+
+                queue[tail++] = *next;
+            }
+        }
+    }
+
+    PyMem_Free(failures);
+    PyMem_Free(queue);
+    return 0;
+}
+
+
+/* magic methods */
+
+
+PyObject* CircularBufferMatcher_create(PyTypeObject* type, PyObject* args,
+        PyObject* kwargs)
+{
+    CircularBufferMatcher* self;
+
+    self = (CircularBufferMatcher*) type->tp_alloc(type, 0);
+    if (self)
+    {
+        self->patterns = NULL;
+        self->pattern_count = 0;
+        self->pattern_lengths = NULL;
+        self->max_length = 0;
+        self->state_count = 0;
+        self->transitions = NULL;
+        self->outputs = NULL;
+        self->output_links = NULL;
+    }
+
+    return (PyObject*) self;
+}
+
+
+int CircularBufferMatcher_initialize(CircularBufferMatcher* self,
+        PyObject* args, PyObject* kwargs)
+{
+    static char* kwlist[] = {"patterns", NULL};
+
+    PyObject* patterns;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", kwlist, &patterns))
+    {
+        return -1;
+    }
+    else if (self->patterns)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "Matcher was already compiled.");
+        return -1;
+    }
+
+    PyObject* sequence = PySequence_Fast(patterns, "patterns must be "
+            "a sequence of bytes");
+    if (sequence == NULL)
+    {
+        return -1;
+    }
+
+    Py_ssize_t count = PySequence_Fast_GET_SIZE(sequence);
+    if (count == 0)
+    {
+        Py_DECREF(sequence);
+        PyErr_SetString(PyExc_ValueError, "At least one pattern is needed.");
+        return -1;
+    }
+
+    self->patterns = PyTuple_New(count);
+    self->pattern_lengths = (Py_ssize_t*) PyMem_Malloc(
+            count * sizeof(Py_ssize_t));
+
+    if (self->patterns == NULL || self->pattern_lengths == NULL)
+    {
+        Py_DECREF(sequence);
+        if (self->pattern_lengths == NULL)
+        {
+            PyErr_NoMemory();
+        }
+        return -1;
+    }
+
+    for (Py_ssize_t i = 0; i < count; i++)
+    {
+        PyObject* pattern = PyBytes_FromObject(
+                PySequence_Fast_GET_ITEM(sequence, i));
+
+        if (pattern == NULL)
+        {
+            Py_DECREF(sequence);
+            return -1;
+        }
+        PyTuple_SET_ITEM(self->patterns, i, pattern);
+
+        Py_ssize_t len = PyBytes_GET_SIZE(pattern);
+        if (len == 0)
+        {
+            Py_DECREF(sequence);
+            PyErr_SetString(PyExc_ValueError, "Patterns cannot be empty.");
+            return -1;
+        }
+        // a duplicate would never be reported under its own id
+        for (Py_ssize_t j = 0; j < i; j++)
+        {
+            PyObject* other = PyTuple_GET_ITEM(self->patterns, j);
+            if (self->pattern_lengths[j] == len && memcmp(
+                    PyBytes_AS_STRING(other), PyBytes_AS_STRING(pattern),
+                    len) == 0)
+            {
+                Py_DECREF(sequence);
+                PyErr_SetString(PyExc_ValueError, "Patterns must be unique.");
+                return -1;
+            }
+        }
+        self->pattern_lengths[i] = len;
+        if (len > self->max_length)
+        {
+            self->max_length = len;
+        }
+        self->pattern_count++;
+    }
+    Py_DECREF(sequence);
+
+    return matcher_compile(self);
+}
+
+
+void CircularBufferMatcher_destroy(CircularBufferMatcher* self)
+{
+    Py_XDECREF(self->patterns);
+    PyMem_Free(self->pattern_lengths);
+    PyMem_Free(self->transitions);
+    PyMem_Free(self->outputs);
+    PyMem_Free(self->output_links);
+    Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+
+Py_ssize_t CircularBufferMatcher_length(CircularBufferMatcher* self)
+{
+    return self->pattern_count;
+}
+
+
+PyObject* CircularBufferMatcher_get_item(CircularBufferMatcher* self,
+        Py_ssize_t pos)
+{
+    if (pos < 0 || pos >= self->pattern_count)
+    {
+        PyErr_SetNone(PyExc_IndexError);
+        return NULL;
+    }
+    PyObject* result = PyTuple_GET_ITEM(self->patterns, pos);
+    Py_INCREF(result);
+    return result;
+}
+
+
+/* meta description */
+
+PySequenceMethods CircularBufferMatcher_sequence[] = {{
+    (lenfunc) CircularBufferMatcher_length,          // sq_length
+    0,                                               // sq_concat
+    0,                                               // sq_repeat
+    (ssizeargfunc) CircularBufferMatcher_get_item,   // sq_item
+}};
+
+
+PyTypeObject CircularBufferMatcherType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "circularbuffer.Matcher",                  // tp_name
+    sizeof(CircularBufferMatcher),             // tp_basicsize
+    0,                                         // tp_itemsize
+    (destructor) CircularBufferMatcher_destroy, // tp_dealloc
+    0,                                         // tp_print (deprecated)
+    0,                                         // tp_getattr (deprecated)
+    0,                                         // tp_setattr (deprecated)
+    0,                                         // tp_compare
+    0,                                         // tp_repr
+    0,                                         // tp_as_number
+    CircularBufferMatcher_sequence,            // tp_as_sequence
+    0,                                         // tp_as_mapping
+    0,                                         // tp_hash
+    0,                                         // tp_call
+    0,                                         // tp_str
+    0,                                         // tp_getattro
+    0,                                         // tp_setattro
+    0,                                         // tp_as_buffer
+    Py_TPFLAGS_DEFAULT,                        // tp_flags
+    "Compiled set of patterns for CircularBuffer.find_any()", // tp_doc
+    0,                                         // tp_traverse
+    0,                                         // tp_clear
+    0,                                         // tp_richcompare
+    0,                                         // tp_weaklistoffset
+    0,                                         // tp_iter
+    0,                                         // tp_iternext
+    0,                                         // tp_methods
+    0,                                         // tp_members
+    0,                                         // tp_getset
+    0,                                         // tp_base
+    0,                                         // tp_dict
+    0,                                         // tp_descr_get
+    0,                                         // tp_descr_set
+    0,                                         // tp_dictoffset
+    (initproc) CircularBufferMatcher_initialize, // tp_init
+    0,                                         // tp_alloc
+    CircularBufferMatcher_create,              // tp_new
+};
+
+
+/* helper functions */
+
+
+/*
+ * Index of the leftmost match of any pattern in one pass over the segments,
+ * when several patterns start there the lowest pattern id wins.
+ */
+Py_ssize_t circularbuffer_matcher_find(CircularBufferMatcher* matcher,
+        CircularBufferSegment* segments, int count, Py_ssize_t* pattern_id)
+{
+    Py_ssize_t best = -1;
+    Py_ssize_t pos = 0;
+    int state = 0;
+
+    *pattern_id = -1;
+
+    for (int i = 0; i < count; i++)
+    {
+        const unsigned char* pread = (const unsigned char*) segments[i].ptr;
+        const unsigned char* pread_end = pread + segments[i].len;
+
+        for (; pread < pread_end; pread++, pos++)
+        {
+            state = matcher->transitions[state * 256 + *pread];
+
+            int found = matcher->outputs[state] >= 0 ? state
+                    : matcher->output_links[state];
+
+            while (found >= 0)
+            {
+                Py_ssize_t id = matcher->outputs[found];
+                Py_ssize_t begin = pos - matcher->pattern_lengths[id] + 1;
+
+                if (best < 0 || begin < best
+                        || (begin == best && id < *pattern_id))
+                {
+                    best = begin;
+                    *pattern_id = id;
+                }
+                found = matcher->output_links[found];
+            }
+
+            // later matches cannot start before the best one
+            if (best >= 0 && pos + 1 - matcher->max_length >= best)
+            {
+                return best;
+            }
+        }
+    }
+    return best;
+}
+
+
+/*
+ * Number of non-overlapping occurences of each pattern, in one pass.
+ */
+void circularbuffer_matcher_count(CircularBufferMatcher* matcher,
+        CircularBufferSegment* segments, int count, Py_ssize_t* counts)
+{
+    // counts doubles as storage for where each pattern may match next,
+    // stored after the counts themselves
+    Py_ssize_t* next_allowed = counts + matcher->pattern_count;
+    Py_ssize_t pos = 0;
+    int state = 0;
+
+    for (Py_ssize_t i = 0; i < matcher->pattern_count; i++)
+    {
+        counts[i] = 0;
+        next_allowed[i] = 0;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        const unsigned char* pread = (const unsigned char*) segments[i].ptr;
+        const unsigned char* pread_end = pread + segments[i].len;
+
+        for (; pread < pread_end; pread++, pos++)
+        {
+            state = matcher->transitions[state * 256 + *pread];
+
+            int found = matcher->outputs[state] >= 0 ? state
+                    : matcher->output_links[state];
+
+            while (found >= 0)
+            {
+                Py_ssize_t id = matcher->outputs[found];
+                if (pos - matcher->pattern_lengths[id] + 1 >= next_allowed[id])
+                {
+                    counts[id] += 1;
+                    next_allowed[id] = pos + 1;
+                }
+                found = matcher->output_links[found];
+            }
+        }
+    }
+}
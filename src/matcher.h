@@ -0,0 +1,36 @@
+#ifndef CIRCULAR_BUFFER_MATCHER_H
+#define CIRCULAR_BUFFER_MATCHER_H
+
+#include "base.h"
+
+/* objects */
+
+// Aho-Corasick automaton, compiled into a full transition table
+typedef struct {
+    PyObject_HEAD
+    PyObject* patterns;
+    Py_ssize_t pattern_count;
+    Py_ssize_t* pattern_lengths;
+    Py_ssize_t max_length;
+
+    Py_ssize_t state_count;
+    // next state, for every state and every byte
+    int* transitions;
+    // lowest pattern id ending at a state, or -1
+    int* outputs;
+    // next state with output along the suffix chain, or -1
+    int* output_links;
+} CircularBufferMatcher;
+
+extern PyTypeObject CircularBufferMatcherType;
+
+/* helper functions */
+
+Py_ssize_t circularbuffer_matcher_find(CircularBufferMatcher* matcher,
+        CircularBufferSegment* segments, int count, Py_ssize_t* pattern_id);
+
+// counts needs room for twice the number of patterns
+void circularbuffer_matcher_count(CircularBufferMatcher* matcher,
+        CircularBufferSegment* segments, int count, Py_ssize_t* counts);
+
+#endif
@@ -1,13 +1,22 @@
 #define PY_SSIZE_T_CLEAN
 #include "base.h"
+#include "arguments.h"
+#include "export.h"
+#include "fdio.h"
+#include "matcher.h"
 #include "methods.h"
+#include "pump.h"
+#include "records.h"
+#include "search.h"
+#include "storage.h"
 
 static const char CIRCULARBUFFER_RESIZE_DOCSTRING[] = QUOTE(
     Increase the size of internal buffer.\n
     \n
     :param size: new buffer size\n
     :returns: actual size of the new buffer\n
-    :raises MemoryError: cannot allocate memory needed
+    :raises MemoryError: cannot allocate memory needed\n
+    :raises ReservedError: someone uses buffer protocol
 );
 
 PyObject *CircularBuffer_resize(CircularBuffer *self, PyObject *args,
@@ -20,26 +29,21 @@ PyObject *CircularBuffer_resize(CircularBuffer *self, PyObject *args,
     {
         return NULL;
     }
-    else if (size > self->allocated)
+    else if (self->elastic)
     {
-        void *new_raw = PyMem_Realloc(self->raw, size + 2);
-        if (new_raw)
-        {
-            self->raw = (char*) new_raw;
-            self->raw[size + 1] = 0;
-            self->allocated = size;
-            if (self->write >= self->read)
-            {
-                self->allocated_before_resize = size;
-            }
-        }
-        else
+        // allocated when the data comes
+        if (size > self->capacity)
         {
-            return PyErr_NoMemory();
+            self->capacity = size;
         }
     }
+    else if (size > self->allocated
+            && circularbuffer_storage_resize(self, size))
+    {
+        return NULL;
+    }
 
-    return Py_BuildValue("n", self->allocated);
+    return Py_BuildValue("n", self->capacity);
 }
 
 
@@ -52,26 +56,29 @@ static const char CIRCULARBUFFER_READ_DOCSTRING[] = QUOTE(
     :raises ReservedError: someone uses buffer protocol
 );
 
-PyObject *CircularBuffer_read(CircularBuffer *self, PyObject *args,
-        PyObject *kwargs)
+PyObject *CircularBuffer_read(CircularBuffer *self,
+        CIRCULARBUFFER_FAST_PARAMETERS)
 {
     static char *kwlist[] = {"size", NULL};
+    PyObject* values[1];
     Py_ssize_t size;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n", kwlist, &size))
+    if (circularbuffer_unpack_arguments(CIRCULARBUFFER_FAST_ARGUMENTS, "read",
+            kwlist, 1, values)
+            || circularbuffer_size_argument(values[0], &size))
     {
         return NULL;
     }
     else if (self->read_lock || self->read_write_lock)
     {
-        PyErr_SetString(ReservedError, "The internal buffer cannot be modified "
-                "at the moment.");
+        circularbuffer_raise(self, ReservedError, "The internal buffer cannot "
+                "be modified at the moment.");
 
         return NULL;
     }
     else if (size == 0)
     {
-        return Py_BuildValue(STR_FORMAT_BYTE, "", 0);
+        return PyBytes_FromStringAndSize("", 0);
     }
 
     Py_ssize_t len = circularbuffer_total_length(self);
@@ -82,79 +89,833 @@ PyObject *CircularBuffer_read(CircularBuffer *self, PyObject *args,
 
     if (end <= start || start < 0 || end < 0)
     {
-        return Py_BuildValue(STR_FORMAT_BYTE, "", 0);
+        return PyBytes_FromStringAndSize("", 0);
     }
 
     PyObject* result = circularbuffer_peek_partial(self, 0, end);
+    if (result)
+    {
+        circularbuffer_consume(self, end - start);
+    }
+    return result;
+}
+
+
+/*
+ * Consume data up to and including the delimiter, resuming the search where
+ * the previous call stopped.
+ */
+static PyObject* read_until(CircularBuffer* self, const char* delimiter,
+        Py_ssize_t delimiter_len, Py_ssize_t max_bytes)
+{
+    if (self->read_lock || self->read_write_lock)
+    {
+        circularbuffer_raise(self, ReservedError, "The internal buffer cannot "
+                "be modified at the moment.");
+
+        return NULL;
+    }
+    else if (delimiter_len == 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "invalid delimiter length");
+        return NULL;
+    }
+
+    if (self->scan_delimiter == NULL
+            || PyBytes_GET_SIZE(self->scan_delimiter) != delimiter_len
+            || memcmp(PyBytes_AS_STRING(self->scan_delimiter), delimiter,
+                delimiter_len))
+    {
+        // what was searched before is no good for another delimiter
+        Py_XDECREF(self->scan_delimiter);
+        self->scan_delimiter = PyBytes_FromStringAndSize(delimiter,
+                delimiter_len);
+
+        self->scan_cursor = 0;
+        if (self->scan_delimiter == NULL)
+        {
+            return NULL;
+        }
+    }
+
+    Py_ssize_t len = circularbuffer_total_length(self);
+    Py_ssize_t end = len;
+    if (max_bytes >= 0 && max_bytes < len)
+    {
+        end = max_bytes;
+    }
+
+    Py_ssize_t size = 0;
+    Py_ssize_t pos = -1;
+    if (self->scan_cursor < end)
+    {
+        CircularBufferSegment segments[2];
+        int count = circularbuffer_data_segments(self, 0, end, segments);
+
+        pos = circularbuffer_search_segments(segments, count,
+                self->scan_cursor, delimiter, delimiter_len);
+    }
+
+    if (pos >= 0)
+    {
+        size = pos + delimiter_len;
+    }
+    else
+    {
+        if (end - delimiter_len + 1 > self->scan_cursor)
+        {
+            self->scan_cursor = end - delimiter_len + 1;
+        }
+        if (max_bytes >= 0 && len >= max_bytes)
+        {
+            // no delimiter within the limit, give what is allowed
+            size = max_bytes;
+        }
+    }
+
+    PyObject* result = circularbuffer_peek_partial(self, 0, size);
+    if (result)
+    {
+        circularbuffer_consume(self, size);
+    }
+    return result;
+}
+
+
+static const char CIRCULARBUFFER_READ_UNTIL_DOCSTRING[] = QUOTE(
+    CB.read_until(delimiter [,max_bytes]) -> bytes\n
+    \n
+    Read from internal buffer up to and including the delimiter. Nothing is
+    read when the delimiter is not there yet, bytes written later are
+    searched without going over the old ones again.\n
+    \n
+    :param delimiter: bytes that end a frame\n
+    :param max_bytes: return at most this many bytes, even without the
+                      delimiter, could be negative which means no limit\n
+    :returns: bytes including the delimiter, or empty bytes\n
+    :raises ReservedError: someone uses buffer protocol
+);
+
+PyObject* CircularBuffer_read_until(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs)
+{
+    static char* kwlist[] = {"delimiter", "max_bytes", NULL};
+
+    const char* delimiter;
+    Py_ssize_t delimiter_len;
+    Py_ssize_t max_bytes = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, STR_FORMAT_BYTE "|n",
+            kwlist, &delimiter, &delimiter_len, &max_bytes))
+    {
+        return NULL;
+    }
+    return read_until(self, delimiter, delimiter_len, max_bytes);
+}
+
+
+static const char CIRCULARBUFFER_READLINE_DOCSTRING[] = QUOTE(
+    CB.readline([max_bytes]) -> bytes\n
+    \n
+    Like CB.read_until() with newline as the delimiter.\n
+    \n
+    :param max_bytes: return at most this many bytes, could be negative
+                      which means no limit\n
+    :returns: bytes including the newline, or empty bytes\n
+    :raises ReservedError: someone uses buffer protocol
+);
+
+PyObject* CircularBuffer_readline(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs)
+{
+    static char* kwlist[] = {"max_bytes", NULL};
+    Py_ssize_t max_bytes = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|n", kwlist, &max_bytes))
+    {
+        return NULL;
+    }
+    return read_until(self, "\n", 1, max_bytes);
+}
+
+
+static const char CIRCULARBUFFER_READINTO_DOCSTRING[] = QUOTE(
+    CB.readinto(buffer) -> int\n
+    \n
+    Read from internal buffer into a writable bytes-like object, without
+    allocating anything.\n
+    \n
+    :param buffer: bytearray, memoryview or other writable buffer\n
+    :returns: number of bytes read, could be smaller than the buffer\n
+    :raises ReservedError: someone uses buffer protocol
+);
+
+PyObject* CircularBuffer_readinto(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs)
+{
+    static char* kwlist[] = {"buffer", NULL};
+    Py_buffer view;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "w*", kwlist, &view))
+    {
+        return NULL;
+    }
+    else if (self->read_lock || self->read_write_lock)
+    {
+        PyBuffer_Release(&view);
+        circularbuffer_raise(self, ReservedError, "The internal buffer cannot "
+                "be modified at the moment.");
+
+        return NULL;
+    }
+
+    Py_ssize_t size = circularbuffer_total_length(self);
+    if (size > view.len)
+    {
+        size = view.len;
+    }
+
+    circularbuffer_copy(self, 0, (char*) view.buf, size);
+    circularbuffer_consume(self, size);
+
+    PyBuffer_Release(&view);
+    return Py_BuildValue("n", size);
+}
+
+
+static const char CIRCULARBUFFER_PEEK_INTO_DOCSTRING[] = QUOTE(
+    CB.peek_into(buffer [,start]) -> int\n
+    \n
+    Like CB.readinto() but leave the data in internal buffer.\n
+    \n
+    :param buffer: bytearray, memoryview or other writable buffer\n
+    :param start: index of the first byte to copy\n
+    :returns: number of bytes copied, could be smaller than the buffer\n
+    :raises RealignmentError: internal buffer is being realign into one segment
+);
+
+PyObject* CircularBuffer_peek_into(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs)
+{
+    static char* kwlist[] = {"buffer", "start", NULL};
+    Py_buffer view;
+    Py_ssize_t start = 0;
+    Py_ssize_t end = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "w*|n", kwlist, &view,
+            &start))
+    {
+        return NULL;
+    }
+    else if (self->read_lock)
+    {
+        PyBuffer_Release(&view);
+        circularbuffer_raise(self, RealignmentError, "This is rare, but "
+                "internal buffer temporarily not available.");
+
+        return NULL;
+    }
+
+    Py_ssize_t len = circularbuffer_total_length(self);
+    circularbuffer_parse_slice_notation(self, len, &start, &end);
+
+    Py_ssize_t size = 0;
+    if (start >= 0 && end > start)
+    {
+        size = end - start;
+        if (size > view.len)
+        {
+            size = view.len;
+        }
+        circularbuffer_copy(self, start, (char*) view.buf, size);
+    }
+
+    PyBuffer_Release(&view);
+    return Py_BuildValue("n", size);
+}
+
+
+/*
+ * Export stored data as read-only memoryviews, one per segment.
+ */
+static PyObject* export_segments(CircularBuffer* self, Py_ssize_t start,
+        Py_ssize_t size)
+{
+    CircularBufferSegment segments[2];
+    int count = circularbuffer_data_segments(self, start, size, segments);
+
+    PyObject* result = PyTuple_New(count);
+    if (result == NULL)
+    {
+        return NULL;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        PyObject* view = circularbuffer_export_memoryview(self,
+                segments[i].ptr, segments[i].len, 1);
+
+        if (view == NULL)
+        {
+            Py_DECREF(result);
+            return NULL;
+        }
+        PyTuple_SET_ITEM(result, i, view);
+    }
+    return result;
+}
+
+
+static const char CIRCULARBUFFER_PEEK_VIEW_DOCSTRING[] = QUOTE(
+    CB.peek_view([size]) -> tuple\n
+    \n
+    Look at the data without copying it, one memoryview per segment of
+    internal buffer. While the memoryviews are alive the data cannot be
+    consumed.\n
+    \n
+    :param size: number of bytes to look at, could be negative which means
+                 all of the data\n
+    :returns: tuple of one or two read-only memoryviews, or empty tuple\n
+    :raises RealignmentError: internal buffer is being realign into one segment
+);
+
+PyObject* CircularBuffer_peek_view(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs)
+{
+    static char* kwlist[] = {"size", NULL};
+    Py_ssize_t size = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|n", kwlist, &size))
+    {
+        return NULL;
+    }
+    else if (self->read_lock)
+    {
+        circularbuffer_raise(self, RealignmentError, "This is rare, but "
+                "internal buffer temporarily not available.");
+
+        return NULL;
+    }
+
+    Py_ssize_t len = circularbuffer_total_length(self);
+    if (size < 0 || size > len)
+    {
+        size = len;
+    }
+
+    return export_segments(self, 0, size);
+}
+
+
+static const char CIRCULARBUFFER_SEGMENTS_DOCSTRING[] = QUOTE(
+    CB.segments([start [,end]]) -> tuple\n
+    \n
+    Export data exactly as it sits in internal buffer, without realigning
+    it, for consumers handling scattered data like socket.sendmsg() or
+    hashlib. While the memoryviews are alive the data cannot be consumed.\n
+    \n
+    :param start: start index, with slice notation\n
+    :param end: end index, with slice notation\n
+    :returns: tuple of one or two read-only memoryviews, or empty tuple\n
+    :raises RealignmentError: internal buffer is being realign into one segment
+);
+
+PyObject* CircularBuffer_segments(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs)
+{
+    static char* kwlist[] = {"start", "end", NULL};
+    Py_ssize_t start = 0;
+    Py_ssize_t end = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nn", kwlist, &start,
+            &end))
+    {
+        return NULL;
+    }
+    else if (self->read_lock)
+    {
+        circularbuffer_raise(self, RealignmentError, "This is rare, but "
+                "internal buffer temporarily not available.");
+
+        return NULL;
+    }
+
+    Py_ssize_t len = circularbuffer_total_length(self);
+    circularbuffer_parse_slice_notation(self, len, &start, &end);
+
+    if (end <= start || start < 0 || end < 0)
+    {
+        return PyTuple_New(0);
+    }
+    return export_segments(self, start, end - start);
+}
+
+
+static const char CIRCULARBUFFER_VIEW_DOCSTRING[] = QUOTE(
+    CB.view([start [,end]]) -> memoryview\n
+    \n
+    Look at a window of the data as one contiguous block, without realigning
+    the whole internal buffer. A window not crossing the end of internal
+    buffer points straight into it and the data cannot be consumed while
+    the memoryview is alive, otherwise only the window is copied.\n
+    \n
+    :param start: start index, with slice notation\n
+    :param end: end index, with slice notation\n
+    :returns: read-only memoryview\n
+    :raises RealignmentError: internal buffer is being realign into one segment
+);
+
+PyObject* CircularBuffer_view(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs)
+{
+    static char* kwlist[] = {"start", "end", NULL};
+    Py_ssize_t start = 0;
+    Py_ssize_t end = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nn", kwlist, &start,
+            &end))
+    {
+        return NULL;
+    }
+    else if (self->read_lock)
+    {
+        circularbuffer_raise(self, RealignmentError, "This is rare, but "
+                "internal buffer temporarily not available.");
+
+        return NULL;
+    }
+
+    Py_ssize_t len = circularbuffer_total_length(self);
+    circularbuffer_parse_slice_notation(self, len, &start, &end);
+
+    len = end > start && start >= 0 ? end - start : 0;
 
-    self->read += end - start;
-    if (self->read > self->allocated_before_resize)
+    CircularBufferSegment segments[2];
+    if (circularbuffer_data_segments(self, start, len, segments) == 1)
     {
-        self->read -= self->allocated_before_resize + 1;
+        return circularbuffer_export_memoryview(self, segments[0].ptr, len, 1);
     }
 
+    // the window wraps around, stage a copy of it rather than realign
+    PyObject* copy = PyBytes_FromStringAndSize(NULL, len);
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    circularbuffer_copy(self, start, PyBytes_AS_STRING(copy), len);
+
+    PyObject* result = PyMemoryView_FromObject(copy);
+    Py_DECREF(copy);
     return result;
 }
 
 
+static const char CIRCULARBUFFER_ADVANCE_DOCSTRING[] = QUOTE(
+    CB.advance(size) -> int\n
+    \n
+    Drop data from internal buffer without returning it.\n
+    \n
+    :param size: number of bytes to drop\n
+    :returns: number of bytes dropped, could be smaller than requested\n
+    :raises ReservedError: someone uses buffer protocol
+);
+
+PyObject* CircularBuffer_advance(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs)
+{
+    static char* kwlist[] = {"size", NULL};
+    Py_ssize_t size;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n", kwlist, &size))
+    {
+        return NULL;
+    }
+    else if (self->read_lock || self->read_write_lock)
+    {
+        circularbuffer_raise(self, ReservedError, "The internal buffer cannot "
+                "be modified at the moment.");
+
+        return NULL;
+    }
+
+    Py_ssize_t len = circularbuffer_total_length(self);
+    if (size < 0)
+    {
+        size = 0;
+    }
+    else if (size > len)
+    {
+        size = len;
+    }
+    circularbuffer_consume(self, size);
+
+    return Py_BuildValue("n", size);
+}
+
+
+/*
+ * Copy data into free space, growing or overwriting as configured.
+ * Returns the number of bytes taken, or -1 with exception set.
+ */
+static Py_ssize_t write_data(CircularBuffer* self, const char* data,
+        Py_ssize_t length)
+{
+    if (length > circularbuffer_total_available(self)
+            && circularbuffer_storage_limit(self) > self->allocated
+            && circularbuffer_storage_grow(self, length))
+    {
+        return -1;
+    }
+
+    Py_ssize_t written = 0;
+    // the reserved space is about to be taken
+    self->reserved = 0;
+
+    if (self->overwrite)
+    {
+        Py_ssize_t evicted = length - circularbuffer_total_available(self);
+        if (evicted > 0 && (self->read_lock || self->read_write_lock))
+        {
+            circularbuffer_raise(self, ReservedError, "The internal buffer "
+                    "cannot be modified at the moment.");
+
+            return -1;
+        }
+        else if (length > self->allocated)
+        {
+            // only the tail of the data is kept
+            Py_ssize_t skipped = length - self->allocated;
+            data += skipped;
+            length -= skipped;
+            written += skipped;
+            self->dropped += skipped;
+            evicted -= skipped;
+        }
+        if (evicted > 0)
+        {
+            // elastic storage must stay while it is being written
+            self->write_lock++;
+            circularbuffer_consume(self, evicted);
+            self->write_lock--;
+            self->dropped += evicted;
+        }
+    }
+
+    // two halves
+    while (length)
+    {
+        Py_ssize_t avail = circularbuffer_forward_available(self);
+        if (avail == 0)
+        {
+            break;
+        }
+
+        Py_ssize_t count = length > avail ? avail : length;
+        char* ptr = &self->raw[CIRCULARBUFFER_WRITE_INDEX(self)];
+        if (self->spsc && count >= CIRCULARBUFFER_NOGIL_SIZE)
+        {
+            // let the consumer run meanwhile, but keep other writers out
+            self->write_lock++;
+            Py_BEGIN_ALLOW_THREADS
+            memcpy(ptr, data, count);
+            Py_END_ALLOW_THREADS
+            self->write_lock--;
+        }
+        else
+        {
+            memcpy(ptr, data, count);
+        }
+
+        length -= count;
+        data += count;
+        written += count;
+
+        // wraps right away, a drained buffer must not look full
+        circularbuffer_produce(self, count);
+    }
+
+    if (written)
+    {
+        self->write_stats.writes++;
+    }
+    if (length)
+    {
+        self->write_stats.short_writes++;
+        self->write_stats.bytes_refused += length;
+    }
+    return written;
+}
+
+
 static const char CIRCULARBUFFER_WRITE_DOCSTRING[] = QUOTE(
     Write into internal buffer.\n
     Type of bytes is expected, and unicode will be automatically encoded with
     utf-8.\n
     \n
     :param data: bytearray to be added to the buffer\n
-    :returns: number of bytes written, could be less than the size of data\n
+    :returns: number of bytes written, could be less than the size of data
+              when internal buffer cannot grow up to max_size, an
+              overwriting buffer drops the oldest data instead\n
+    :raises MemoryError: cannot allocate memory needed to grow\n
     :raises RealignmentError: internal buffer is being realign into one segment
 );
 
-PyObject* CircularBuffer_write(CircularBuffer* self, PyObject* args,
+PyObject* CircularBuffer_write(CircularBuffer* self,
+        CIRCULARBUFFER_FAST_PARAMETERS)
+{
+    static char* kwlist[] = {"data", NULL};
+
+    PyObject* values[1];
+    const char* data;
+    Py_ssize_t length;
+
+    if (circularbuffer_unpack_arguments(CIRCULARBUFFER_FAST_ARGUMENTS, "write",
+            kwlist, 1, values)
+            || circularbuffer_bytes_argument(values[0], &data, &length))
+    {
+        return NULL;
+    }
+    else if (self->write_lock)
+    {
+        circularbuffer_raise(self, RealignmentError, "This is rare, but "
+                "internal buffer temporarily not available.");
+
+        return NULL;
+    }
+
+    Py_ssize_t written = write_data(self, data, length);
+    if (written < 0)
+    {
+        return NULL;
+    }
+    return PyLong_FromSsize_t(written);
+}
+
+
+static const char CIRCULARBUFFER_WRITE_MANY_DOCSTRING[] = QUOTE(
+    CB.write_many(items) -> tuple\n
+    \n
+    Write items one after another in one call, as long as whole items fit.
+    The first item which does not fit is not written, nor any after it, the
+    number of items written is the index to continue from.\n
+    \n
+    :param items: sequence of bytes-like objects\n
+    :returns: number of items and number of bytes written\n
+    :raises TypeError: not a sequence or an item is not bytes-like, nothing
+                       is written then\n
+    :raises MemoryError: cannot allocate memory needed to grow\n
+    :raises RealignmentError: internal buffer is being realign into one segment
+);
+
+PyObject* CircularBuffer_write_many(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs)
+{
+    static char* kwlist[] = {"items", NULL};
+
+    PyObject* items;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", kwlist, &items))
+    {
+        return NULL;
+    }
+    else if (self->write_lock)
+    {
+        circularbuffer_raise(self, RealignmentError, "This is rare, but "
+                "internal buffer temporarily not available.");
+
+        return NULL;
+    }
+    else if (!PySequence_Check(items))
+    {
+        // items taken from an iterator could not be given back
+        PyErr_SetString(PyExc_TypeError, "items must be a sequence of "
+                "bytes-like objects");
+        return NULL;
+    }
+
+    PyObject* sequence = PySequence_Fast(items, "items must be a sequence of "
+            "bytes-like objects");
+    if (sequence == NULL)
+    {
+        return NULL;
+    }
+
+    Py_ssize_t length = PySequence_Fast_GET_SIZE(sequence);
+    PyObject** item = PySequence_Fast_ITEMS(sequence);
+
+    // all or nothing when an item is of a wrong type
+    for (Py_ssize_t i = 0; i < length; i++)
+    {
+        if (!PyObject_CheckBuffer(item[i]))
+        {
+            Py_DECREF(sequence);
+            PyErr_Format(PyExc_TypeError, "a bytes-like object is required, "
+                    "not '%.100s'", Py_TYPE(item[i])->tp_name);
+            return NULL;
+        }
+    }
+
+    Py_ssize_t count = 0;
+    Py_ssize_t written = 0;
+
+    for (; count < length; count++)
+    {
+        Py_buffer data;
+        if (PyObject_GetBuffer(item[count], &data, PyBUF_SIMPLE))
+        {
+            break;
+        }
+
+        Py_ssize_t result;
+        if (!self->overwrite && data.len > circularbuffer_total_available(self)
+                && circularbuffer_storage_limit(self) > self->allocated
+                && circularbuffer_storage_grow(self, data.len))
+        {
+            result = -1;
+        }
+        else if (!self->overwrite
+                && data.len > circularbuffer_total_available(self))
+        {
+            // does not fit as a whole
+            self->write_stats.short_writes++;
+            self->write_stats.bytes_refused += data.len;
+            result = -2;
+        }
+        else
+        {
+            result = write_data(self, (const char*) data.buf, data.len);
+        }
+
+        PyBuffer_Release(&data);
+
+        if (result < 0)
+        {
+            break;
+        }
+        written += result;
+    }
+    Py_DECREF(sequence);
+
+    if (PyErr_Occurred())
+    {
+        return NULL;
+    }
+    return Py_BuildValue("(nn)", count, written);
+}
+
+
+static const char CIRCULARBUFFER_RESERVE_DOCSTRING[] = QUOTE(
+    CB.reserve([size]) -> memoryview\n
+    \n
+    Hand out free space of internal buffer to be written directly, for
+    example with socket.recv_into(), the data becomes visible with
+    CB.commit(). Only contiguous free space is reserved, reserve again after
+    commit to get the rest.\n
+    \n
+    :param size: maximum number of bytes to reserve, could be negative which
+                 means as much as possible\n
+    :returns: writable memoryview, could be smaller than requested\n
+    :raises RealignmentError: free space is being written, by the pump or
+                              through memoryview of previous reservation\n
+    :raises ReservedError: previous reservation was not committed
+);
+
+PyObject* CircularBuffer_reserve(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs)
+{
+    static char* kwlist[] = {"size", NULL};
+    Py_ssize_t size = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|n", kwlist, &size))
+    {
+        return NULL;
+    }
+    else if (self->reserved)
+    {
+        circularbuffer_raise(self, ReservedError, "Previous reservation was "
+                "not committed.");
+
+        return NULL;
+    }
+    else if (self->write_lock)
+    {
+        // free space is written by the pump or through another export
+        circularbuffer_raise(self, RealignmentError, "This is rare, but "
+                "internal buffer temporarily not available.");
+
+        return NULL;
+    }
+    else if (circularbuffer_storage_prepare(self, size))
+    {
+        return NULL;
+    }
+
+    Py_ssize_t avail;
+    if (self->storage == CIRCULARBUFFER_STORAGE_MIRROR)
+    {
+        avail = circularbuffer_total_available(self);
+    }
+    else
+    {
+        avail = circularbuffer_forward_available(self);
+    }
+    if (size < 0 || size > avail)
+    {
+        size = avail;
+    }
+
+    PyObject* result = circularbuffer_export_memoryview(self,
+            &self->raw[CIRCULARBUFFER_WRITE_INDEX(self)], size, 0);
+
+    if (result)
+    {
+        self->reserved = size;
+    }
+    return result;
+}
+
+
+static const char CIRCULARBUFFER_COMMIT_DOCSTRING[] = QUOTE(
+    CB.commit(size) -> int\n
+    \n
+    Add data written into memoryview from CB.reserve() to the buffer.\n
+    \n
+    :param size: number of bytes written into the reservation\n
+    :returns: number of bytes added\n
+    :raises ReservedError: buffer is filled by CB.start_pump()\n
+    :raises ValueError: size is larger than the reservation
+);
+
+PyObject* CircularBuffer_commit(CircularBuffer* self, PyObject* args,
         PyObject* kwargs)
 {
-    static char* kwlist[] = {"data", NULL};
-
-    const char* data;
-    Py_ssize_t length;
+    static char* kwlist[] = {"size", NULL};
+    Py_ssize_t size;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, STR_FORMAT_BYTE, kwlist,
-            &data, &length))
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n", kwlist, &size))
     {
         return NULL;
     }
-    else if (self->write_lock)
+    else if (self->pump)
     {
-        PyErr_SetString(RealignmentError, "This is rare, but internal buffer "
-                "temporarily not available.");
+        // the pump thread owns the write index
+        circularbuffer_raise(self, ReservedError, "The internal buffer cannot "
+                "be modified at the moment.");
 
         return NULL;
     }
-
-    Py_ssize_t written = 0;
-
-    // two halves
-    while (length)
+    else if (size < 0 || size > self->reserved)
     {
-        Py_ssize_t avail = circularbuffer_forward_available(self);
-        if (avail == 0)
-        {
-            break;
-        }
-        else if (self->write == self->allocated  + 1)
-        {
-            self->write = 0;
-        }
-
-        Py_ssize_t count = length > avail ? avail : length;
-        memcpy(&self->raw[self->write], data, count);
-
-        length -= count;
-        data += count;
-        written += count;
+        PyErr_SetString(PyExc_ValueError, "Cannot commit more than was "
+                "reserved.");
 
-        self->write += count;
-        self->raw[self->write] = 0;
+        return NULL;
     }
 
-    return Py_BuildValue("n", written);
+    circularbuffer_produce(self, size);
+    self->write_stats.writes++;
+    self->reserved = 0;
+
+    return Py_BuildValue("n", size);
 }
 
 
@@ -166,8 +927,77 @@ static const char CIRCULARBUFFER_WRITE_AVAILABLE_DOCSTRING[] = QUOTE(
 
 PyObject* CircularBuffer_write_available(CircularBuffer* self)
 {
-    Py_ssize_t size = circularbuffer_total_available(self);
-    return Py_BuildValue("n", size);
+    if (self->elastic)
+    {
+        // space not allocated yet counts too
+        return PyLong_FromSsize_t(self->capacity
+                - circularbuffer_total_length(self));
+    }
+    return PyLong_FromSsize_t(circularbuffer_total_available(self));
+}
+
+
+static const char CIRCULARBUFFER_DROPPED_DOCSTRING[] = QUOTE(
+    CB.dropped() -> int\n
+    \n
+    Number of bytes an overwriting buffer has dropped to make room for new
+    data, since it was created.\n
+    \n
+    :returns: number of bytes dropped
+);
+
+PyObject* CircularBuffer_dropped(CircularBuffer* self)
+{
+    return Py_BuildValue("n", self->dropped);
+}
+
+
+static const char CIRCULARBUFFER_STATS_DOCSTRING[] = QUOTE(
+    CB.stats([reset]) -> dict\n
+    \n
+    Counters kept since the buffer was created or last reset. Reading side:
+    bytes_read and reads, bytes dropped by an overwriting buffer are counted
+    as read. Writing side: bytes_written, writes, short_writes and
+    bytes_refused for data which did not fit, high_watermark for the most
+    data ever stored. Rare events: realignments and realigned_bytes moved by
+    CB.make_contiguous(), resizes, reserved_errors and realignment_errors
+    raised.\n
+    \n
+    :param reset: zero the counters after reading them\n
+    :returns: dictionary of counters
+);
+
+PyObject* CircularBuffer_stats(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs)
+{
+    static char* kwlist[] = {"reset", NULL};
+    int reset = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|i", kwlist, &reset))
+    {
+        return NULL;
+    }
+
+    PyObject* result = Py_BuildValue(
+            "{sKsKsKsKsKsKsnsKsKsKsKsK}",
+            "bytes_read", self->read_stats.bytes_read,
+            "reads", self->read_stats.reads,
+            "bytes_written", self->write_stats.bytes_written,
+            "writes", self->write_stats.writes,
+            "short_writes", self->write_stats.short_writes,
+            "bytes_refused", self->write_stats.bytes_refused,
+            "high_watermark", self->write_stats.high_watermark,
+            "realignments", self->stats.realignments,
+            "realigned_bytes", self->stats.realigned_bytes,
+            "reserved_errors", self->stats.reserved_errors,
+            "realignment_errors", self->stats.realignment_errors,
+            "resizes", self->stats.resizes);
+
+    if (result && reset)
+    {
+        circularbuffer_stats_reset(self);
+    }
+    return result;
 }
 
 
@@ -179,23 +1009,25 @@ static const char CIRCULARBUFFER_COUNT_DOCSTRING[] = QUOTE(
     :raises RealignmentError: internal buffer is being realign into one segment
 );
 
-PyObject* CircularBuffer_count(CircularBuffer* self, PyObject* args,
-        PyObject* kwargs)
+PyObject* CircularBuffer_count(CircularBuffer* self,
+        CIRCULARBUFFER_FAST_PARAMETERS)
 {
     static char* kwlist[] = {"text", NULL};
 
+    PyObject* values[1];
     const char* search;
     Py_ssize_t search_len;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, STR_FORMAT_BYTE, kwlist,
-            &search, &search_len))
+    if (circularbuffer_unpack_arguments(CIRCULARBUFFER_FAST_ARGUMENTS,
+            "count", kwlist, 1, values)
+            || circularbuffer_bytes_argument(values[0], &search, &search_len))
     {
         return NULL;
     }
     else if (self->read_lock)
     {
-        PyErr_SetString(RealignmentError, "This is rare, but internal buffer "
-                "temporarily not available.");
+        circularbuffer_raise(self, RealignmentError, "This is rare, but "
+                "internal buffer temporarily not available.");
 
         return NULL;
     }
@@ -206,49 +1038,14 @@ PyObject* CircularBuffer_count(CircularBuffer* self, PyObject* args,
         return NULL;
     }
 
-    const char* psearch = search;
-    const char* psearch_end = psearch + search_len;
-
-    const char* pread = circularbuffer_readptr(self);
-    const char* pread_half_end;
-    if (self->write < self->read)
-    {
-        pread_half_end = self->raw + self->allocated_before_resize;
-    }
-    else
-    {
-        pread_half_end = self->raw + self->write;
-    }
-
-    Py_ssize_t count = 0;
+    CircularBufferSegment segments[2];
+    int segment_count = circularbuffer_data_segments(self, 0,
+            circularbuffer_total_length(self), segments);
 
-    while (pread < pread_half_end)
-    {
-        psearch = pread[0] == psearch[0] ? psearch + 1 : search;
-        if (psearch == psearch_end)
-        {
-            count += 1;
-            psearch = search;
-        }
-        pread += 1;
-    }
-    if (self->write < self->read)
-    {
-        pread = self->raw;
-        pread_half_end = self->raw + self->write;
+    Py_ssize_t count = circularbuffer_search_count(segments, segment_count,
+            search, search_len);
 
-        while (pread < pread_half_end)
-        {
-            psearch = pread[0] == psearch[0] ? psearch + 1 : search;
-            if (psearch == psearch_end)
-            {
-                count += 1;
-                psearch = search;
-            }
-            pread += 1;
-        }
-    }
-    return Py_BuildValue("n", count);
+    return PyLong_FromSsize_t(count);
 }
 
 
@@ -261,16 +1058,36 @@ static const char CIRCULARBUFFER_CLEAR_DOCSTRING[] = QUOTE(
 
 PyObject* CircularBuffer_clear(CircularBuffer* self)
 {
-    if (self->write_lock || self->read_write_lock)
+    if (self->spsc)
+    {
+        if (self->read_lock || self->read_write_lock)
+        {
+            circularbuffer_raise(self, ReservedError, "The internal buffer "
+                    "cannot be modified at the moment.");
+
+            return NULL;
+        }
+        // the write pointer belongs to the producer
+        circularbuffer_consume(self, circularbuffer_total_length(self));
+        self->scan_cursor = 0;
+        Py_RETURN_NONE;
+    }
+    else if (self->write_lock || self->read_write_lock)
     {
-        PyErr_SetString(ReservedError, "The internal buffer cannot be modified "
-                "at the moment.");
+        circularbuffer_raise(self, ReservedError, "The internal buffer cannot "
+                "be modified at the moment.");
 
         return NULL;
     }
     self->write = self->read = 0;
     self->raw[0] = 0;
     self->allocated_before_resize = self->allocated;
+    self->reserved = 0;
+    self->scan_cursor = 0;
+    if (self->elastic)
+    {
+        circularbuffer_storage_idle(self);
+    }
     Py_RETURN_NONE;
 }
 
@@ -282,23 +1099,25 @@ static const char CIRCULARBUFFER_STARTSWITH_DOCSTRING[] = QUOTE(
     :raises RealignmentError: internal buffer is being realign into one segment
 );
 
-PyObject* CircularBuffer_startswith(CircularBuffer* self, PyObject* args,
-        PyObject* kwargs)
+PyObject* CircularBuffer_startswith(CircularBuffer* self,
+        CIRCULARBUFFER_FAST_PARAMETERS)
 {
     static char* kwlist[] = {"prefix", NULL};
 
+    PyObject* values[1];
     const char* search;
     Py_ssize_t search_len;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, STR_FORMAT_BYTE, kwlist,
-            &search, &search_len))
+    if (circularbuffer_unpack_arguments(CIRCULARBUFFER_FAST_ARGUMENTS,
+            "startswith", kwlist, 1, values)
+            || circularbuffer_bytes_argument(values[0], &search, &search_len))
     {
         return NULL;
     }
     else if (self->read_lock)
     {
-        PyErr_SetString(RealignmentError, "This is rare, but internal buffer "
-                "temporarily not available.");
+        circularbuffer_raise(self, RealignmentError, "This is rare, but "
+                "internal buffer temporarily not available.");
 
         return NULL;
     }
@@ -312,14 +1131,7 @@ PyObject* CircularBuffer_startswith(CircularBuffer* self, PyObject* args,
     Py_ssize_t pos = circularbuffer_find(self, search, search_len, 0,
             search_len);
 
-    if (pos < 0)
-    {
-        return Py_BuildValue("i", 0);
-    }
-    else
-    {
-        return Py_BuildValue("i", 1);
-    }
+    return PyBool_FromLong(pos >= 0);
 }
 
 
@@ -338,25 +1150,29 @@ static const char CIRCULARBUFFER_FIND_DOCSTRING[] = QUOTE(
     :returns: index of first occurence\n
 );
 
-PyObject* CircularBuffer_find(CircularBuffer* self, PyObject* args,
-        PyObject* kwargs)
+PyObject* CircularBuffer_find(CircularBuffer* self,
+        CIRCULARBUFFER_FAST_PARAMETERS)
 {
     static char* kwlist[] = {"sub", "start", "end", NULL};
 
+    PyObject* values[3];
     const char* search;
     Py_ssize_t search_len;
     Py_ssize_t start = 0;
     Py_ssize_t end = -1;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, STR_FORMAT_BYTE "|nn",
-            kwlist, &search, &search_len, &start, &end))
+    if (circularbuffer_unpack_arguments(CIRCULARBUFFER_FAST_ARGUMENTS, "find",
+            kwlist, 1, values)
+            || circularbuffer_bytes_argument(values[0], &search, &search_len)
+            || circularbuffer_size_argument(values[1], &start)
+            || circularbuffer_size_argument(values[2], &end))
     {
         return NULL;
     }
     else if (self->read_lock)
     {
-        PyErr_SetString(RealignmentError, "This is rare, but internal buffer "
-                "temporarily not available.");
+        circularbuffer_raise(self, RealignmentError, "This is rare, but "
+                "internal buffer temporarily not available.");
 
         return NULL;
     }
@@ -367,7 +1183,7 @@ PyObject* CircularBuffer_find(CircularBuffer* self, PyObject* args,
         return NULL;
     }
 
-    return Py_BuildValue("n", circularbuffer_find(self, search, search_len,
+    return PyLong_FromSsize_t(circularbuffer_find(self, search, search_len,
                 start, end));
 }
 
@@ -384,25 +1200,29 @@ static const char CIRCULARBUFFER_INDEX_DOCSTRING[] = QUOTE(
     :raises ValueError: unable to find sub\n
 );
 
-PyObject* CircularBuffer_index(CircularBuffer* self, PyObject* args,
-        PyObject* kwargs)
+PyObject* CircularBuffer_index(CircularBuffer* self,
+        CIRCULARBUFFER_FAST_PARAMETERS)
 {
     static char* kwlist[] = {"sub", "start", "end", NULL};
 
+    PyObject* values[3];
     const char* search;
     Py_ssize_t search_len;
     Py_ssize_t start = 0;
     Py_ssize_t end = -1;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, STR_FORMAT_BYTE "|nn",
-            kwlist, &search, &search_len, &start, &end))
+    if (circularbuffer_unpack_arguments(CIRCULARBUFFER_FAST_ARGUMENTS, "index",
+            kwlist, 1, values)
+            || circularbuffer_bytes_argument(values[0], &search, &search_len)
+            || circularbuffer_size_argument(values[1], &start)
+            || circularbuffer_size_argument(values[2], &end))
     {
         return NULL;
     }
     else if (self->read_lock)
     {
-        PyErr_SetString(RealignmentError, "This is rare, but internal buffer "
-                "temporarily not available.");
+        circularbuffer_raise(self, RealignmentError, "This is rare, but "
+                "internal buffer temporarily not available.");
 
         return NULL;
     }
@@ -421,8 +1241,158 @@ PyObject* CircularBuffer_index(CircularBuffer* self, PyObject* args,
     }
     else
     {
-        return Py_BuildValue("n", pos);
+        return PyLong_FromSsize_t(pos);
+    }
+}
+
+
+static const char CIRCULARBUFFER_FIND_ANY_DOCSTRING[] = QUOTE(
+    CB.find_any(matcher [,start [,end]]) -> (int, int)\n
+    \n
+    Return the lowest index in CB where any pattern of the matcher is found,
+    together with the index of that pattern, such that it is contained within
+    CB[start:end]. Optional arguments start and end are interpreted as in
+    slice notation. When several patterns start at the same index, the one
+    listed first wins.\n
+    \n
+    Return (-1, -1) on failure.\n
+    \n
+    :param matcher: circularbuffer.Matcher of the patterns to search\n
+    :param start: index for partial search\n
+    :param end: index for partial search\n
+    :returns: tuple of index and pattern index\n
+    :raises ValueError: matcher was not initialized\n
+    :raises RealignmentError: internal buffer is being realign into one segment
+);
+
+PyObject* CircularBuffer_find_any(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs)
+{
+    static char* kwlist[] = {"matcher", "start", "end", NULL};
+
+    CircularBufferMatcher* matcher;
+    Py_ssize_t start = 0;
+    Py_ssize_t end = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!|nn", kwlist,
+            &CircularBufferMatcherType, &matcher, &start, &end))
+    {
+        return NULL;
+    }
+    else if (matcher->transitions == NULL)
+    {
+        PyErr_SetString(PyExc_ValueError, "Matcher was not compiled.");
+        return NULL;
+    }
+    else if (self->read_lock)
+    {
+        circularbuffer_raise(self, RealignmentError, "This is rare, but "
+                "internal buffer temporarily not available.");
+
+        return NULL;
+    }
+
+    Py_ssize_t len = circularbuffer_total_length(self);
+    circularbuffer_parse_slice_notation(self, len, &start, &end);
+
+    Py_ssize_t pos = -1;
+    Py_ssize_t pattern_id = -1;
+
+    if (end > start && start >= 0)
+    {
+        CircularBufferSegment segments[2];
+        int count = circularbuffer_data_segments(self, start, end - start,
+                segments);
+
+        pos = circularbuffer_matcher_find(matcher, segments, count,
+                &pattern_id);
+
+        if (pos >= 0)
+        {
+            pos += start;
+        }
+    }
+
+    return Py_BuildValue("(nn)", pos, pattern_id);
+}
+
+
+static const char CIRCULARBUFFER_COUNT_ANY_DOCSTRING[] = QUOTE(
+    CB.count_any(matcher [,start [,end]]) -> tuple\n
+    \n
+    Return the number of non-overlapping occurences of each pattern of the
+    matcher, counted in one pass.\n
+    \n
+    :param matcher: circularbuffer.Matcher of the patterns to search\n
+    :param start: index for partial search\n
+    :param end: index for partial search\n
+    :returns: tuple of number of occurences, in the order of the patterns\n
+    :raises ValueError: matcher was not initialized\n
+    :raises RealignmentError: internal buffer is being realign into one segment
+);
+
+PyObject* CircularBuffer_count_any(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs)
+{
+    static char* kwlist[] = {"matcher", "start", "end", NULL};
+
+    CircularBufferMatcher* matcher;
+    Py_ssize_t start = 0;
+    Py_ssize_t end = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!|nn", kwlist,
+            &CircularBufferMatcherType, &matcher, &start, &end))
+    {
+        return NULL;
+    }
+    else if (matcher->transitions == NULL)
+    {
+        PyErr_SetString(PyExc_ValueError, "Matcher was not compiled.");
+        return NULL;
+    }
+    else if (self->read_lock)
+    {
+        circularbuffer_raise(self, RealignmentError, "This is rare, but "
+                "internal buffer temporarily not available.");
+
+        return NULL;
+    }
+
+    Py_ssize_t len = circularbuffer_total_length(self);
+    circularbuffer_parse_slice_notation(self, len, &start, &end);
+
+    // room for the counts and the scan state of each pattern
+    Py_ssize_t* counts = (Py_ssize_t*) PyMem_Malloc(
+            2 * matcher->pattern_count * sizeof(Py_ssize_t));
+
+    if (counts == NULL)
+    {
+        return PyErr_NoMemory();
+    }
+
+    CircularBufferSegment segments[2];
+    int count = 0;
+    if (end > start && start >= 0)
+    {
+        count = circularbuffer_data_segments(self, start, end - start,
+                segments);
+    }
+    circularbuffer_matcher_count(matcher, segments, count, counts);
+
+    PyObject* result = PyTuple_New(matcher->pattern_count);
+    for (Py_ssize_t i = 0; result && i < matcher->pattern_count; i++)
+    {
+        PyObject* item = PyLong_FromSsize_t(counts[i]);
+        if (item == NULL)
+        {
+            Py_CLEAR(result);
+            break;
+        }
+        PyTuple_SET_ITEM(result, i, item);
     }
+
+    PyMem_Free(counts);
+    return result;
 }
 
 
@@ -490,15 +1460,69 @@ PyMethodDef CircularBuffer_methods[] = {
     {
         "count",
         (PyCFunction) CircularBuffer_count,
-        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_FAST_FLAGS,
         CIRCULARBUFFER_COUNT_DOCSTRING
     },
     {
         "read",
         (PyCFunction) CircularBuffer_read,
-        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_FAST_FLAGS,
         CIRCULARBUFFER_READ_DOCSTRING
     },
+    {
+        "read_until",
+        (PyCFunction) CircularBuffer_read_until,
+        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_READ_UNTIL_DOCSTRING
+    },
+    {
+        "readline",
+        (PyCFunction) CircularBuffer_readline,
+        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_READLINE_DOCSTRING
+    },
+    {
+        "readinto",
+        (PyCFunction) CircularBuffer_readinto,
+        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_READINTO_DOCSTRING
+    },
+    {
+        "peek_into",
+        (PyCFunction) CircularBuffer_peek_into,
+        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_PEEK_INTO_DOCSTRING
+    },
+    {
+        "peek_view",
+        (PyCFunction) CircularBuffer_peek_view,
+        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_PEEK_VIEW_DOCSTRING
+    },
+    {
+        "segments",
+        (PyCFunction) CircularBuffer_segments,
+        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_SEGMENTS_DOCSTRING
+    },
+    {
+        "view",
+        (PyCFunction) CircularBuffer_view,
+        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_VIEW_DOCSTRING
+    },
+    {
+        "advance",
+        (PyCFunction) CircularBuffer_advance,
+        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_ADVANCE_DOCSTRING
+    },
+    {
+        "discard",
+        (PyCFunction) CircularBuffer_advance,
+        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_ADVANCE_DOCSTRING
+    },
     {
         "resize",
         (PyCFunction) CircularBuffer_resize,
@@ -508,33 +1532,129 @@ PyMethodDef CircularBuffer_methods[] = {
     {
         "startswith",
         (PyCFunction) CircularBuffer_startswith,
-        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_FAST_FLAGS,
         CIRCULARBUFFER_STARTSWITH_DOCSTRING
     },
     {
         "write",
         (PyCFunction) CircularBuffer_write,
-        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_FAST_FLAGS,
         CIRCULARBUFFER_WRITE_DOCSTRING
     },
+    {
+        "write_many",
+        (PyCFunction) CircularBuffer_write_many,
+        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_WRITE_MANY_DOCSTRING
+    },
+    {
+        "reserve",
+        (PyCFunction) CircularBuffer_reserve,
+        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_RESERVE_DOCSTRING
+    },
+    {
+        "commit",
+        (PyCFunction) CircularBuffer_commit,
+        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_COMMIT_DOCSTRING
+    },
+    {
+        "fill_from_fd",
+        (PyCFunction) CircularBuffer_fill_from_fd,
+        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_FILL_FROM_FD_DOCSTRING
+    },
+    {
+        "drain_to_fd",
+        (PyCFunction) CircularBuffer_drain_to_fd,
+        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_DRAIN_TO_FD_DOCSTRING
+    },
+    {
+        "write_record",
+        (PyCFunction) CircularBuffer_write_record,
+        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_WRITE_RECORD_DOCSTRING
+    },
+    {
+        "read_record",
+        (PyCFunction) CircularBuffer_read_record,
+        METH_NOARGS,
+        CIRCULARBUFFER_READ_RECORD_DOCSTRING
+    },
+    {
+        "read_records",
+        (PyCFunction) CircularBuffer_read_records,
+        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_READ_RECORDS_DOCSTRING
+    },
+    {
+        "peek_record_len",
+        (PyCFunction) CircularBuffer_peek_record_len,
+        METH_NOARGS,
+        CIRCULARBUFFER_PEEK_RECORD_LEN_DOCSTRING
+    },
+    {
+        "start_pump",
+        (PyCFunction) CircularBuffer_start_pump,
+        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_START_PUMP_DOCSTRING
+    },
+    {
+        "stop_pump",
+        (PyCFunction) CircularBuffer_stop_pump,
+        METH_NOARGS,
+        CIRCULARBUFFER_STOP_PUMP_DOCSTRING
+    },
+    {
+        "is_pumping",
+        (PyCFunction) CircularBuffer_is_pumping,
+        METH_NOARGS,
+        CIRCULARBUFFER_IS_PUMPING_DOCSTRING
+    },
     {
         "write_available",
         (PyCFunction) CircularBuffer_write_available,
         METH_NOARGS,
         CIRCULARBUFFER_WRITE_AVAILABLE_DOCSTRING
     },
+    {
+        "dropped",
+        (PyCFunction) CircularBuffer_dropped,
+        METH_NOARGS,
+        CIRCULARBUFFER_DROPPED_DOCSTRING
+    },
+    {
+        "stats",
+        (PyCFunction) CircularBuffer_stats,
+        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_STATS_DOCSTRING
+    },
     {
         "find",
         (PyCFunction) CircularBuffer_find,
-        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_FAST_FLAGS,
         CIRCULARBUFFER_FIND_DOCSTRING
     },
     {
         "index",
         (PyCFunction) CircularBuffer_index,
-        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_FAST_FLAGS,
         CIRCULARBUFFER_INDEX_DOCSTRING
     },
+    {
+        "find_any",
+        (PyCFunction) CircularBuffer_find_any,
+        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_FIND_ANY_DOCSTRING
+    },
+    {
+        "count_any",
+        (PyCFunction) CircularBuffer_count_any,
+        METH_VARARGS | METH_KEYWORDS,
+        CIRCULARBUFFER_COUNT_ANY_DOCSTRING
+    },
     {
         "make_contiguous",
         (PyCFunction) CircularBuffer_make_contiguous,
@@ -2,30 +2,75 @@
 #define CIRCULAR_BUFFER_METHODS_H
 
 #include "base.h"
+#include "arguments.h"
 
 PyObject *CircularBuffer_resize(CircularBuffer *self, PyObject *args,
         PyObject *kwargs);
 
-PyObject *CircularBuffer_read(CircularBuffer *self, PyObject *args,
-        PyObject *kwargs);
+PyObject* CircularBuffer_read(CircularBuffer* self,
+        CIRCULARBUFFER_FAST_PARAMETERS);
+
+PyObject* CircularBuffer_read_until(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs);
+
+PyObject* CircularBuffer_readline(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs);
+
+PyObject* CircularBuffer_readinto(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs);
 
-PyObject* CircularBuffer_write(CircularBuffer* self, PyObject* args,
+PyObject* CircularBuffer_peek_into(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs);
+
+PyObject* CircularBuffer_peek_view(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs);
+
+PyObject* CircularBuffer_segments(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs);
+
+PyObject* CircularBuffer_view(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs);
+
+PyObject* CircularBuffer_advance(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs);
+
+PyObject* CircularBuffer_write(CircularBuffer* self,
+        CIRCULARBUFFER_FAST_PARAMETERS);
+
+PyObject* CircularBuffer_write_many(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs);
+
+PyObject* CircularBuffer_reserve(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs);
+
+PyObject* CircularBuffer_commit(CircularBuffer* self, PyObject* args,
         PyObject* kwargs);
 
 PyObject* CircularBuffer_write_available(CircularBuffer* self);
 
-PyObject* CircularBuffer_count(CircularBuffer* self, PyObject* args,
+PyObject* CircularBuffer_dropped(CircularBuffer* self);
+
+PyObject* CircularBuffer_stats(CircularBuffer* self, PyObject* args,
         PyObject* kwargs);
 
+PyObject* CircularBuffer_count(CircularBuffer* self,
+        CIRCULARBUFFER_FAST_PARAMETERS);
+
 PyObject* CircularBuffer_clear(CircularBuffer* self);
 
-PyObject* CircularBuffer_startswith(CircularBuffer* self, PyObject* args,
-        PyObject* kwargs);
+PyObject* CircularBuffer_startswith(CircularBuffer* self,
+        CIRCULARBUFFER_FAST_PARAMETERS);
+
+PyObject* CircularBuffer_find(CircularBuffer* self,
+        CIRCULARBUFFER_FAST_PARAMETERS);
+
+PyObject* CircularBuffer_index(CircularBuffer* self,
+        CIRCULARBUFFER_FAST_PARAMETERS);
 
-PyObject* CircularBuffer_find(CircularBuffer* self, PyObject* args,
+PyObject* CircularBuffer_find_any(CircularBuffer* self, PyObject* args,
         PyObject* kwargs);
 
-PyObject* CircularBuffer_index(CircularBuffer* self, PyObject* args,
+PyObject* CircularBuffer_count_any(CircularBuffer* self, PyObject* args,
         PyObject* kwargs);
 
 
@@ -0,0 +1,297 @@
+#define PY_SSIZE_T_CLEAN
+#include "pool.h"
+
+
+/*
+ * Whether a released buffer may be handed out again as a fresh one.
+ */
+static int pool_accepts(CircularBufferPool* self, CircularBuffer* buf)
+{
+    return buf->raw != NULL
+            && buf->allocated == self->size_class
+            && buf->storage == CIRCULARBUFFER_STORAGE_HEAP
+            && !buf->spsc && !buf->overwrite && !buf->max_size
+            && !buf->elastic
+            && !buf->pump
+            && !buf->read_lock && !buf->read_write_lock && !buf->write_lock
+            && self->free_count < self->max_free;
+}
+
+
+/*
+ * Drop stored data and everything remembered about it, keep the storage.
+ */
+static void pool_reset(CircularBuffer* buf)
+{
+    buf->read = 0;
+    buf->write = 0;
+    buf->allocated_before_resize = buf->allocated;
+    buf->raw[0] = 0;
+    buf->reserved = 0;
+    buf->dropped = 0;
+    buf->scan_cursor = 0;
+    Py_CLEAR(buf->scan_delimiter);
+    circularbuffer_stats_reset(buf);
+}
+
+
+/* magic methods */
+
+
+PyObject* CircularBufferPool_create(PyTypeObject* type, PyObject* args,
+        PyObject* kwargs)
+{
+    CircularBufferPool* self;
+
+    self = (CircularBufferPool*) type->tp_alloc(type, 0);
+    if (self)
+    {
+        self->size_class = 0;
+        self->max_free = 0;
+        self->free_count = 0;
+        self->free = NULL;
+        self->acquires = 0;
+        self->hits = 0;
+        self->releases = 0;
+        self->discarded = 0;
+    }
+
+    return (PyObject*) self;
+}
+
+
+int CircularBufferPool_initialize(CircularBufferPool* self, PyObject* args,
+        PyObject* kwargs)
+{
+    static char* kwlist[] = {"size_class", "max_free", NULL};
+
+    Py_ssize_t size_class;
+    Py_ssize_t max_free = 64;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|n", kwlist, &size_class,
+            &max_free))
+    {
+        return -1;
+    }
+    else if (size_class < 0 || max_free < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "Size class and max_free cannot be "
+                "negative.");
+
+        return -1;
+    }
+    else if (self->free)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "Pool was already initialized.");
+        return -1;
+    }
+
+    // one slot more, so that an empty pool still has an array
+    self->free = (CircularBuffer**) PyMem_Malloc(
+            (max_free + 1) * sizeof(CircularBuffer*));
+
+    if (self->free == NULL)
+    {
+        PyErr_NoMemory();
+        return -1;
+    }
+    self->size_class = size_class;
+    self->max_free = max_free;
+    return 0;
+}
+
+
+void CircularBufferPool_destroy(CircularBufferPool* self)
+{
+    for (Py_ssize_t i = 0; i < self->free_count; i++)
+    {
+        Py_DECREF(self->free[i]);
+    }
+    PyMem_Free(self->free);
+    Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+
+Py_ssize_t CircularBufferPool_length(CircularBufferPool* self)
+{
+    return self->free_count;
+}
+
+
+/* methods */
+
+
+static const char CIRCULARBUFFER_POOL_ACQUIRE_DOCSTRING[] = QUOTE(
+    BP.acquire() -> CircularBuffer\n
+    \n
+    Take an empty buffer of the size class, a released one when available,
+    otherwise a new one.\n
+    \n
+    :returns: empty CircularBuffer\n
+    :raises MemoryError: cannot allocate a new buffer
+);
+
+PyObject* CircularBufferPool_acquire(CircularBufferPool* self)
+{
+    if (self->free == NULL)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "Pool was not initialized.");
+        return NULL;
+    }
+
+    self->acquires++;
+    if (self->free_count)
+    {
+        // the reference held by the pool goes to the caller
+        self->hits++;
+        return (PyObject*) self->free[--self->free_count];
+    }
+    return PyObject_CallFunction((PyObject*) &CircularBufferType, "n",
+            self->size_class);
+}
+
+
+static const char CIRCULARBUFFER_POOL_RELEASE_DOCSTRING[] = QUOTE(
+    BP.release(buf) -> bool\n
+    \n
+    Give a buffer back to the pool, its data is dropped. The buffer must not
+    be used afterwards, it is handed out again by BP.acquire(). Buffers of
+    another size, with a special configuration or still in use by buffer
+    protocol are not kept, nor any beyond max_free.\n
+    \n
+    :param buf: CircularBuffer to recycle\n
+    :returns: whether the buffer was kept\n
+    :raises TypeError: not a CircularBuffer\n
+    :raises ValueError: buffer is in the pool already
+);
+
+PyObject* CircularBufferPool_release(CircularBufferPool* self, PyObject* arg)
+{
+    if (Py_TYPE(arg) != &CircularBufferType)
+    {
+        PyErr_Format(PyExc_TypeError, "CircularBuffer is required, not "
+                "'%.100s'", Py_TYPE(arg)->tp_name);
+        return NULL;
+    }
+
+    CircularBuffer* buf = (CircularBuffer*) arg;
+    for (Py_ssize_t i = 0; i < self->free_count; i++)
+    {
+        if (self->free[i] == buf)
+        {
+            PyErr_SetString(PyExc_ValueError, "Buffer was already released.");
+            return NULL;
+        }
+    }
+
+    self->releases++;
+    if (self->free == NULL || !pool_accepts(self, buf))
+    {
+        self->discarded++;
+        Py_RETURN_FALSE;
+    }
+
+    pool_reset(buf);
+    Py_INCREF(buf);
+    self->free[self->free_count++] = buf;
+    Py_RETURN_TRUE;
+}
+
+
+static const char CIRCULARBUFFER_POOL_STATS_DOCSTRING[] = QUOTE(
+    BP.stats() -> dict\n
+    \n
+    Counters of the pool: acquires, hits served from released buffers,
+    misses which created a new one, releases, discarded buffers not kept,
+    free buffers waiting and hit_rate.\n
+    \n
+    :returns: dictionary of counters
+);
+
+PyObject* CircularBufferPool_stats(CircularBufferPool* self)
+{
+    double hit_rate = self->acquires
+            ? (double) self->hits / (double) self->acquires : 0.0;
+
+    return Py_BuildValue("{sKsKsKsKsKsnsd}",
+            "acquires", self->acquires,
+            "hits", self->hits,
+            "misses", self->acquires - self->hits,
+            "releases", self->releases,
+            "discarded", self->discarded,
+            "free", self->free_count,
+            "hit_rate", hit_rate);
+}
+
+
+static PyMethodDef CircularBufferPool_methods[] = {
+    {
+        "acquire",
+        (PyCFunction) CircularBufferPool_acquire,
+        METH_NOARGS,
+        CIRCULARBUFFER_POOL_ACQUIRE_DOCSTRING
+    },
+    {
+        "release",
+        (PyCFunction) CircularBufferPool_release,
+        METH_O,
+        CIRCULARBUFFER_POOL_RELEASE_DOCSTRING
+    },
+    {
+        "stats",
+        (PyCFunction) CircularBufferPool_stats,
+        METH_NOARGS,
+        CIRCULARBUFFER_POOL_STATS_DOCSTRING
+    },
+    // end of array
+    {NULL},
+};
+
+
+/* meta description */
+
+PySequenceMethods CircularBufferPool_sequence[] = {{
+    (lenfunc) CircularBufferPool_length,             // sq_length
+}};
+
+
+PyTypeObject CircularBufferPoolType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "circularbuffer.BufferPool",               // tp_name
+    sizeof(CircularBufferPool),                // tp_basicsize
+    0,                                         // tp_itemsize
+    (destructor) CircularBufferPool_destroy,   // tp_dealloc
+    0,                                         // tp_print (deprecated)
+    0,                                         // tp_getattr (deprecated)
+    0,                                         // tp_setattr (deprecated)
+    0,                                         // tp_compare
+    0,                                         // tp_repr
+    0,                                         // tp_as_number
+    CircularBufferPool_sequence,               // tp_as_sequence
+    0,                                         // tp_as_mapping
+    0,                                         // tp_hash
+    0,                                         // tp_call
+    0,                                         // tp_str
+    0,                                         // tp_getattro
+    0,                                         // tp_setattro
+    0,                                         // tp_as_buffer
+    Py_TPFLAGS_DEFAULT,                        // tp_flags
+    "Free list of CircularBuffer objects of one size", // tp_doc
+    0,                                         // tp_traverse
+    0,                                         // tp_clear
+    0,                                         // tp_richcompare
+    0,                                         // tp_weaklistoffset
+    0,                                         // tp_iter
+    0,                                         // tp_iternext
+    CircularBufferPool_methods,                // tp_methods
+    0,                                         // tp_members
+    0,                                         // tp_getset
+    0,                                         // tp_base
+    0,                                         // tp_dict
+    0,                                         // tp_descr_get
+    0,                                         // tp_descr_set
+    0,                                         // tp_dictoffset
+    (initproc) CircularBufferPool_initialize,  // tp_init
+    0,                                         // tp_alloc
+    CircularBufferPool_create,                 // tp_new
+};
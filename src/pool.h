@@ -0,0 +1,24 @@
+#ifndef CIRCULAR_BUFFER_POOL_H
+#define CIRCULAR_BUFFER_POOL_H
+
+#include "base.h"
+
+/* objects */
+
+// recycles buffers of one size, with their internal storage
+typedef struct {
+    PyObject_HEAD
+    Py_ssize_t size_class;
+    Py_ssize_t max_free;
+    Py_ssize_t free_count;
+    CircularBuffer** free;
+
+    unsigned long long acquires;
+    unsigned long long hits;
+    unsigned long long releases;
+    unsigned long long discarded;
+} CircularBufferPool;
+
+extern PyTypeObject CircularBufferPoolType;
+
+#endif
@@ -0,0 +1,389 @@
+#define PY_SSIZE_T_CLEAN
+#include "pump.h"
+#include "storage.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define CIRCULARBUFFER_HAVE_PUMP
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <pthread.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+
+#ifdef CIRCULARBUFFER_HAVE_PUMP
+
+struct CircularBufferPump {
+    pthread_t thread;
+    int fd;
+    Py_ssize_t chunk;
+
+    // read end is handed out, readable while data is waiting
+    int notify[2];
+    // wakes the thread up from poll() when stopping
+    int control[2];
+    // the thread waits here while the buffer is full
+    pthread_mutex_t mutex;
+    pthread_cond_t space;
+
+    int stopping;
+    int running;
+    // a byte was put into notify since the consumer emptied the buffer
+    int signaled;
+    int error;
+    int spsc;
+};
+
+
+static int pump_pipe(int fds[2])
+{
+    if (pipe(fds) < 0)
+    {
+        return -1;
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+        fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+    }
+    return 0;
+}
+
+
+static void pump_poke(int fd)
+{
+    // a full pipe is readable already
+    ssize_t result = write(fd, "", 1);
+    (void) result;
+}
+
+
+/*
+ * Body of the pump thread, never touches Python objects.
+ */
+static void* pump_run(void* arg)
+{
+    CircularBuffer* self = (CircularBuffer*) arg;
+    struct CircularBufferPump* pump = self->pump;
+    struct pollfd fds[2];
+
+    fds[0].fd = pump->fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = pump->control[0];
+    fds[1].events = POLLIN;
+
+    while (!__atomic_load_n(&pump->stopping, __ATOMIC_ACQUIRE))
+    {
+        CircularBufferSegment segments[2];
+        int count = circularbuffer_free_segments(self, pump->chunk, segments);
+
+        if (count == 0)
+        {
+            // buffer is full, wait for the consumer
+            pthread_mutex_lock(&pump->mutex);
+            while (!__atomic_load_n(&pump->stopping, __ATOMIC_ACQUIRE)
+                    && circularbuffer_total_available(self) == 0)
+            {
+                pthread_cond_wait(&pump->space, &pump->mutex);
+            }
+            pthread_mutex_unlock(&pump->mutex);
+            continue;
+        }
+
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            pump->error = errno;
+            break;
+        }
+        else if (fds[1].revents)
+        {
+            continue;
+        }
+
+        struct iovec iov[2];
+        for (int i = 0; i < count; i++)
+        {
+            iov[i].iov_base = segments[i].ptr;
+            iov[i].iov_len = segments[i].len;
+        }
+
+        ssize_t result = readv(pump->fd, iov, count);
+        if (result < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                continue;
+            }
+            pump->error = errno;
+            break;
+        }
+        else if (result == 0)
+        {
+            // end of file
+            break;
+        }
+
+        circularbuffer_produce(self, result);
+        self->write_stats.writes++;
+        if (!__atomic_exchange_n(&pump->signaled, 1, __ATOMIC_SEQ_CST))
+        {
+            pump_poke(pump->notify[1]);
+        }
+    }
+
+    // consumer should notice the pump has stopped
+    __atomic_store_n(&pump->running, 0, __ATOMIC_RELEASE);
+    pump_poke(pump->notify[1]);
+    return NULL;
+}
+
+
+static void pump_free(struct CircularBufferPump* pump)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        close(pump->notify[i]);
+        close(pump->control[i]);
+    }
+    pthread_cond_destroy(&pump->space);
+    pthread_mutex_destroy(&pump->mutex);
+    PyMem_Free(pump);
+}
+
+#endif
+
+
+const char CIRCULARBUFFER_START_PUMP_DOCSTRING[] = QUOTE(
+    CB.start_pump(fd [,chunk]) -> int\n
+    \n
+    Start native thread which reads from file descriptor straight into
+    internal buffer, without the GIL. Until CB.stop_pump() the thread is
+    the only producer, the buffer acts as single-producer single-consumer
+    one.\n
+    \n
+    :param fd: file descriptor, or object with fileno() method\n
+    :param chunk: maximum number of bytes read at once\n
+    :returns: file descriptor for select() or poll(), readable while data is
+              waiting or when the pump has stopped\n
+    :raises OSError: cannot create the thread\n
+    :raises RuntimeError: pump is already running\n
+    :raises ReservedError: free space was reserved with CB.reserve()
+);
+
+PyObject* CircularBuffer_start_pump(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs)
+{
+    static char* kwlist[] = {"fd", "chunk", NULL};
+
+    PyObject* file;
+    Py_ssize_t chunk = 65536;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|n", kwlist, &file,
+            &chunk))
+    {
+        return NULL;
+    }
+
+    int fd = PyObject_AsFileDescriptor(file);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    else if (chunk <= 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "Chunk size must be positive.");
+        return NULL;
+    }
+    else if (self->pump)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "Pump is already running.");
+        return NULL;
+    }
+    else if (self->write_lock || self->reserved)
+    {
+        circularbuffer_raise(self, ReservedError, "The internal buffer cannot "
+                "be modified at the moment.");
+
+        return NULL;
+    }
+
+#ifdef CIRCULARBUFFER_HAVE_PUMP
+    // elastic storage cannot grow behind the back of the thread
+    if (circularbuffer_storage_prepare(self, self->capacity))
+    {
+        return NULL;
+    }
+
+    struct CircularBufferPump* pump = (struct CircularBufferPump*) PyMem_Malloc(
+            sizeof(struct CircularBufferPump));
+
+    if (pump == NULL)
+    {
+        return PyErr_NoMemory();
+    }
+
+    pump->fd = fd;
+    pump->chunk = chunk;
+    pump->stopping = 0;
+    pump->running = 1;
+    pump->signaled = 0;
+    pump->error = 0;
+    pump->spsc = self->spsc;
+
+    if (pump_pipe(pump->notify) < 0)
+    {
+        PyMem_Free(pump);
+        return PyErr_SetFromErrno(PyExc_OSError);
+    }
+    else if (pump_pipe(pump->control) < 0)
+    {
+        PyErr_SetFromErrno(PyExc_OSError);
+        close(pump->notify[0]);
+        close(pump->notify[1]);
+        PyMem_Free(pump);
+        return NULL;
+    }
+    pthread_mutex_init(&pump->mutex, NULL);
+    pthread_cond_init(&pump->space, NULL);
+
+    // the thread owns the write side, reads keep working alongside
+    self->pump = pump;
+    self->write_lock++;
+    self->spsc = 1;
+
+    int error = pthread_create(&pump->thread, NULL, pump_run, self);
+    if (error)
+    {
+        self->spsc = pump->spsc;
+        self->write_lock--;
+        self->pump = NULL;
+        pump_free(pump);
+
+        errno = error;
+        return PyErr_SetFromErrno(PyExc_OSError);
+    }
+
+    return Py_BuildValue("i", pump->notify[0]);
+#else
+    PyErr_SetString(PyExc_NotImplementedError, "Pump is not supported on this "
+            "platform.");
+
+    return NULL;
+#endif
+}
+
+
+const char CIRCULARBUFFER_STOP_PUMP_DOCSTRING[] = QUOTE(
+    CB.stop_pump() -> None\n
+    \n
+    Stop the thread started by CB.start_pump() and close its notification
+    file descriptor, data read so far stays in the buffer.\n
+    \n
+    :raises OSError: reading has failed, the pump has stopped because of it
+);
+
+PyObject* CircularBuffer_stop_pump(CircularBuffer* self)
+{
+    int error = circularbuffer_pump_stop(self);
+    if (error)
+    {
+        errno = error;
+        return PyErr_SetFromErrno(PyExc_OSError);
+    }
+    Py_RETURN_NONE;
+}
+
+
+const char CIRCULARBUFFER_IS_PUMPING_DOCSTRING[] = QUOTE(
+    CB.is_pumping() -> bool\n
+    \n
+    Check whether the pump is still reading, it stops by itself on end of
+    file or on error.
+);
+
+PyObject* CircularBuffer_is_pumping(CircularBuffer* self)
+{
+#ifdef CIRCULARBUFFER_HAVE_PUMP
+    if (self->pump && __atomic_load_n(&self->pump->running, __ATOMIC_ACQUIRE))
+    {
+        Py_RETURN_TRUE;
+    }
+#endif
+    Py_RETURN_FALSE;
+}
+
+
+/* helper functions */
+
+
+/*
+ * Stop the pump thread and give the write side back.
+ */
+int circularbuffer_pump_stop(CircularBuffer* self)
+{
+#ifdef CIRCULARBUFFER_HAVE_PUMP
+    struct CircularBufferPump* pump = self->pump;
+    if (pump == NULL)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&pump->mutex);
+    __atomic_store_n(&pump->stopping, 1, __ATOMIC_RELEASE);
+    pthread_cond_signal(&pump->space);
+    pthread_mutex_unlock(&pump->mutex);
+    pump_poke(pump->control[1]);
+
+    // the thread never needs the GIL, it exits right away
+    pthread_join(pump->thread, NULL);
+
+    int error = pump->error;
+    self->spsc = pump->spsc;
+    self->write_lock--;
+    self->pump = NULL;
+    pump_free(pump);
+    return error;
+#else
+    return 0;
+#endif
+}
+
+
+/*
+ * Wake up the pump waiting for space, keep notification readable only while
+ * there is data.
+ */
+void circularbuffer_pump_consumed(CircularBuffer* self)
+{
+#ifdef CIRCULARBUFFER_HAVE_PUMP
+    struct CircularBufferPump* pump = self->pump;
+
+    pthread_mutex_lock(&pump->mutex);
+    pthread_cond_signal(&pump->space);
+    pthread_mutex_unlock(&pump->mutex);
+
+    if (circularbuffer_total_length(self) == 0
+            && __atomic_load_n(&pump->running, __ATOMIC_ACQUIRE))
+    {
+        char tmp[64];
+
+        __atomic_store_n(&pump->signaled, 0, __ATOMIC_SEQ_CST);
+        while (read(pump->notify[0], tmp, sizeof(tmp)) > 0)
+        {
+        }
+        // the pump may have written meanwhile, and its byte was just drained
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (circularbuffer_total_length(self) > 0)
+        {
+            __atomic_store_n(&pump->signaled, 1, __ATOMIC_SEQ_CST);
+            pump_poke(pump->notify[1]);
+        }
+    }
+#endif
+}
@@ -0,0 +1,25 @@
+#ifndef CIRCULAR_BUFFER_PUMP_H
+#define CIRCULAR_BUFFER_PUMP_H
+
+#include "base.h"
+
+PyObject* CircularBuffer_start_pump(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs);
+
+PyObject* CircularBuffer_stop_pump(CircularBuffer* self);
+
+PyObject* CircularBuffer_is_pumping(CircularBuffer* self);
+
+extern const char CIRCULARBUFFER_START_PUMP_DOCSTRING[];
+extern const char CIRCULARBUFFER_STOP_PUMP_DOCSTRING[];
+extern const char CIRCULARBUFFER_IS_PUMPING_DOCSTRING[];
+
+/* helper functions */
+
+// returns errno of the failure that ended the pump, or 0
+int circularbuffer_pump_stop(CircularBuffer* self);
+
+// called by the consumer after moving the read pointer
+void circularbuffer_pump_consumed(CircularBuffer* self);
+
+#endif
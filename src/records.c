@@ -0,0 +1,310 @@
+#define PY_SSIZE_T_CLEAN
+#include "records.h"
+#include "storage.h"
+
+
+/*
+ * Copy into free space, which must be large enough.
+ */
+static void record_put(CircularBuffer* self, const char* data, Py_ssize_t size)
+{
+    CircularBufferSegment segments[2];
+    int count = circularbuffer_free_segments(self, size, segments);
+
+    for (int i = 0; i < count; i++)
+    {
+        memcpy(segments[i].ptr, data, segments[i].len);
+        data += segments[i].len;
+    }
+    circularbuffer_produce(self, size);
+}
+
+
+/*
+ * Payload length of the first record, or -1 while its header is incomplete.
+ */
+static Py_ssize_t record_length(CircularBuffer* self)
+{
+    unsigned char header[CIRCULARBUFFER_RECORD_HEADER];
+
+    if (circularbuffer_total_length(self) < CIRCULARBUFFER_RECORD_HEADER)
+    {
+        return -1;
+    }
+    circularbuffer_copy(self, 0, (char*) header, CIRCULARBUFFER_RECORD_HEADER);
+
+    return (Py_ssize_t) ((size_t) header[0] | (size_t) header[1] << 8
+            | (size_t) header[2] << 16 | (size_t) header[3] << 24);
+}
+
+
+/*
+ * Whether a record of the payload length could ever be stored, otherwise
+ * its header is garbage written by something else than CB.write_record().
+ */
+static int record_possible(CircularBuffer* self, Py_ssize_t len)
+{
+    Py_ssize_t limit = circularbuffer_storage_limit(self);
+
+    return CIRCULARBUFFER_RECORD_HEADER + len
+            <= (limit > self->allocated ? limit : self->allocated);
+}
+
+
+/*
+ * Whether the first header is longer than any record could be, which means
+ * the stored data is out of sync with the records.
+ */
+static int record_corrupt(CircularBuffer* self)
+{
+    Py_ssize_t len = record_length(self);
+
+    return len >= 0 && !record_possible(self, len);
+}
+
+
+/*
+ * Remove the first record when it is complete, NULL without exception set
+ * otherwise. Data which cannot be a record raises ValueError and stays,
+ * unless overwriting buffer has evicted the start of the record.
+ */
+static PyObject* record_pop(CircularBuffer* self)
+{
+    if (record_corrupt(self) && self->overwrite)
+    {
+        Py_ssize_t garbage = circularbuffer_total_length(self);
+        circularbuffer_consume(self, garbage);
+        self->dropped += garbage;
+        return NULL;
+    }
+    else if (record_corrupt(self))
+    {
+        PyErr_SetString(PyExc_ValueError, "Stored data is not a record.");
+        return NULL;
+    }
+
+    Py_ssize_t len = record_length(self);
+    if (len < 0 || circularbuffer_total_length(self)
+            < CIRCULARBUFFER_RECORD_HEADER + len)
+    {
+        return NULL;
+    }
+
+    PyObject* result = PyBytes_FromStringAndSize(NULL, len);
+    if (result)
+    {
+        circularbuffer_copy(self, CIRCULARBUFFER_RECORD_HEADER,
+                PyBytes_AS_STRING(result), len);
+        circularbuffer_consume(self, CIRCULARBUFFER_RECORD_HEADER + len);
+    }
+    return result;
+}
+
+
+const char CIRCULARBUFFER_WRITE_RECORD_DOCSTRING[] = QUOTE(
+    CB.write_record(data) -> bool\n
+    \n
+    Write data as one record, prefixed with its length. Either all of it is
+    written or nothing, overwriting buffer drops whole oldest records to
+    make room.\n
+    \n
+    :param data: bytes-like object\n
+    :returns: True if written, False if it does not fit\n
+    :raises MemoryError: cannot allocate memory needed to grow\n
+    :raises OverflowError: data is larger than 4 GiB\n
+    :raises RealignmentError: internal buffer is being realign into one segment
+);
+
+PyObject* CircularBuffer_write_record(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs)
+{
+    static char* kwlist[] = {"data", NULL};
+
+    Py_buffer data;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, STR_FORMAT_BUFFER, kwlist,
+            &data))
+    {
+        return NULL;
+    }
+    else if (self->write_lock)
+    {
+        PyBuffer_Release(&data);
+        circularbuffer_raise(self, RealignmentError, "This is rare, but "
+                "internal buffer temporarily not available.");
+
+        return NULL;
+    }
+    else if ((unsigned long long) data.len > 0xffffffffULL)
+    {
+        PyBuffer_Release(&data);
+        PyErr_SetString(PyExc_OverflowError, "Record is too large.");
+        return NULL;
+    }
+
+    Py_ssize_t size = CIRCULARBUFFER_RECORD_HEADER + data.len;
+    // the reserved space is about to be taken
+    self->reserved = 0;
+
+    if (size > circularbuffer_total_available(self)
+            && circularbuffer_storage_limit(self) > self->allocated
+            && circularbuffer_storage_grow(self, size))
+    {
+        PyBuffer_Release(&data);
+        return NULL;
+    }
+
+    if (self->overwrite && size <= self->allocated)
+    {
+        while (size > circularbuffer_total_available(self))
+        {
+            if (self->read_lock || self->read_write_lock)
+            {
+                PyBuffer_Release(&data);
+                circularbuffer_raise(self, ReservedError, "The internal buffer "
+                        "cannot be modified at the moment.");
+
+                return NULL;
+            }
+            Py_ssize_t len = record_length(self);
+            Py_ssize_t stored = circularbuffer_total_length(self);
+            // anything else than a record is dropped as a whole
+            len = len < 0 || !record_possible(self, len) ? stored
+                    : CIRCULARBUFFER_RECORD_HEADER + len;
+            len = len < stored ? len : stored;
+
+            // elastic storage must stay while it is being written
+            self->write_lock++;
+            circularbuffer_consume(self, len);
+            self->write_lock--;
+            self->dropped += len;
+        }
+    }
+
+    if (size > circularbuffer_total_available(self))
+    {
+        self->write_stats.short_writes++;
+        self->write_stats.bytes_refused += size;
+        PyBuffer_Release(&data);
+        Py_RETURN_FALSE;
+    }
+
+    unsigned char header[CIRCULARBUFFER_RECORD_HEADER] = {
+        (unsigned char) data.len,
+        (unsigned char) (data.len >> 8),
+        (unsigned char) (data.len >> 16),
+        (unsigned char) (data.len >> 24),
+    };
+    record_put(self, (const char*) header, CIRCULARBUFFER_RECORD_HEADER);
+    record_put(self, (const char*) data.buf, data.len);
+    self->write_stats.writes++;
+
+    PyBuffer_Release(&data);
+    Py_RETURN_TRUE;
+}
+
+
+const char CIRCULARBUFFER_READ_RECORD_DOCSTRING[] = QUOTE(
+    CB.read_record() -> bytes\n
+    \n
+    Read one record written by CB.write_record(). Overwriting buffer drops
+    stored data with a header longer than the buffer could ever hold.\n
+    \n
+    :returns: payload of the record, or None if it is not complete yet\n
+    :raises ValueError: stored data is not a record, it is left in place\n
+    :raises ReservedError: someone uses buffer protocol
+);
+
+PyObject* CircularBuffer_read_record(CircularBuffer* self)
+{
+    if (self->read_lock || self->read_write_lock)
+    {
+        circularbuffer_raise(self, ReservedError, "The internal buffer cannot "
+                "be modified at the moment.");
+
+        return NULL;
+    }
+
+    PyObject* result = record_pop(self);
+    if (result == NULL && !PyErr_Occurred())
+    {
+        Py_RETURN_NONE;
+    }
+    return result;
+}
+
+
+const char CIRCULARBUFFER_READ_RECORDS_DOCSTRING[] = QUOTE(
+    CB.read_records([max_n]) -> list\n
+    \n
+    Read all complete records written by CB.write_record() at once.\n
+    \n
+    :param max_n: maximum number of records, could be negative which means
+                  all of them\n
+    :returns: list of payloads, could be empty\n
+    :raises ValueError: stored data is not a record, raised only when no
+                        record was read before it\n
+    :raises ReservedError: someone uses buffer protocol
+);
+
+PyObject* CircularBuffer_read_records(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs)
+{
+    static char* kwlist[] = {"max_n", NULL};
+    Py_ssize_t max_n = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|n", kwlist, &max_n))
+    {
+        return NULL;
+    }
+    else if (self->read_lock || self->read_write_lock)
+    {
+        circularbuffer_raise(self, ReservedError, "The internal buffer cannot "
+                "be modified at the moment.");
+
+        return NULL;
+    }
+
+    PyObject* result = PyList_New(0);
+    while (result && max_n != 0)
+    {
+        if (PyList_GET_SIZE(result) && record_corrupt(self))
+        {
+            // the records read so far are not lost, the next call raises
+            break;
+        }
+
+        PyObject* record = record_pop(self);
+        if (record == NULL)
+        {
+            if (PyErr_Occurred())
+            {
+                Py_CLEAR(result);
+            }
+            break;
+        }
+
+        int error = PyList_Append(result, record);
+        Py_DECREF(record);
+        if (error)
+        {
+            Py_CLEAR(result);
+        }
+        max_n--;
+    }
+    return result;
+}
+
+
+const char CIRCULARBUFFER_PEEK_RECORD_LEN_DOCSTRING[] = QUOTE(
+    CB.peek_record_len() -> int\n
+    \n
+    Payload length of the first record, which may not be complete yet.\n
+    \n
+    :returns: length in bytes, or -1 if there is no record header yet
+);
+
+PyObject* CircularBuffer_peek_record_len(CircularBuffer* self)
+{
+    return Py_BuildValue("n", record_length(self));
+}
@@ -0,0 +1,24 @@
+#ifndef CIRCULAR_BUFFER_RECORDS_H
+#define CIRCULAR_BUFFER_RECORDS_H
+
+#include "base.h"
+
+// every record starts with its length, as unsigned 32 bits little endian
+#define CIRCULARBUFFER_RECORD_HEADER 4
+
+PyObject* CircularBuffer_write_record(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs);
+
+PyObject* CircularBuffer_read_record(CircularBuffer* self);
+
+PyObject* CircularBuffer_read_records(CircularBuffer* self, PyObject* args,
+        PyObject* kwargs);
+
+PyObject* CircularBuffer_peek_record_len(CircularBuffer* self);
+
+extern const char CIRCULARBUFFER_WRITE_RECORD_DOCSTRING[];
+extern const char CIRCULARBUFFER_READ_RECORD_DOCSTRING[];
+extern const char CIRCULARBUFFER_READ_RECORDS_DOCSTRING[];
+extern const char CIRCULARBUFFER_PEEK_RECORD_LEN_DOCSTRING[];
+
+#endif
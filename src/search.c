@@ -0,0 +1,290 @@
+#define PY_SSIZE_T_CLEAN
+#include "search.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) \
+        && (defined(__x86_64__) || defined(__i386__))
+    #define CIRCULARBUFFER_HAVE_X86_SIMD
+    #include <immintrin.h>
+#endif
+
+// below this size building the skip table costs more than it saves
+#define HORSPOOL_MIN_LENGTH 256
+
+
+typedef Py_ssize_t (*search_function)(const char*, Py_ssize_t, const char*,
+        Py_ssize_t);
+
+
+/*
+ * Filter candidates by the first byte with memchr, verify with memcmp.
+ */
+static Py_ssize_t search_memchr(const char* haystack, Py_ssize_t len,
+        const char* needle, Py_ssize_t needle_len)
+{
+    const char* pread = haystack;
+    const char* pread_end = haystack + len - needle_len + 1;
+
+    while (pread < pread_end)
+    {
+        pread = (const char*) memchr(pread, needle[0], pread_end - pread);
+        if (pread == NULL)
+        {
+            break;
+        }
+        else if (memcmp(pread + 1, needle + 1, needle_len - 1) == 0)
+        {
+            return pread - haystack;
+        }
+        pread += 1;
+    }
+    return -1;
+}
+
+
+/*
+ * Boyer-Moore-Horspool, for long haystacks.
+ */
+static Py_ssize_t search_horspool(const char* haystack, Py_ssize_t len,
+        const char* needle, Py_ssize_t needle_len)
+{
+    Py_ssize_t skip[256];
+    const unsigned char* text = (const unsigned char*) haystack;
+    const unsigned char last = (unsigned char) needle[needle_len - 1];
+
+    for (int i = 0; i < 256; i++)
+    {
+        skip[i] = needle_len;
+    }
+    for (Py_ssize_t i = 0; i < needle_len - 1; i++)
+    {
+        skip[(unsigned char) needle[i]] = needle_len - 1 - i;
+    }
+
+    Py_ssize_t pos = 0;
+    while (pos <= len - needle_len)
+    {
+        unsigned char c = text[pos + needle_len - 1];
+        if (c == last && memcmp(haystack + pos, needle, needle_len - 1) == 0)
+        {
+            return pos;
+        }
+        pos += skip[c];
+    }
+    return -1;
+}
+
+
+static Py_ssize_t search_scalar(const char* haystack, Py_ssize_t len,
+        const char* needle, Py_ssize_t needle_len)
+{
+    if (needle_len > 2 && len >= HORSPOOL_MIN_LENGTH)
+    {
+        return search_horspool(haystack, len, needle, needle_len);
+    }
+    return search_memchr(haystack, len, needle, needle_len);
+}
+
+
+#ifdef CIRCULARBUFFER_HAVE_X86_SIMD
+
+/*
+ * Compare the first and the last byte of the needle at 16 or 32 positions at
+ * once, only verify positions where both matched.
+ * see: http://0x80.pl/articles/simd-strfind.html
+ */
+__attribute__((target("sse2")))
+static Py_ssize_t search_sse2(const char* haystack, Py_ssize_t len,
+        const char* needle, Py_ssize_t needle_len)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[needle_len - 1]);
+    Py_ssize_t pos = 0;
+
+    for (; pos + needle_len + 15 <= len; pos += 16)
+    {
+        __m128i block_first = _mm_loadu_si128(
+                (const __m128i*) (haystack + pos));
+        __m128i block_last = _mm_loadu_si128(
+                (const __m128i*) (haystack + pos + needle_len - 1));
+
+        unsigned int mask = (unsigned int) _mm_movemask_epi8(_mm_and_si128(
+                _mm_cmpeq_epi8(first, block_first),
+                _mm_cmpeq_epi8(last, block_last)));
+
+        while (mask)
+        {
+            int bit = __builtin_ctz(mask);
+            if (memcmp(haystack + pos + bit + 1, needle + 1,
+                    needle_len - 2) == 0)
+            {
+                return pos + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    Py_ssize_t found = search_scalar(haystack + pos, len - pos, needle,
+            needle_len);
+    return found < 0 ? found : pos + found;
+}
+
+
+__attribute__((target("avx2")))
+static Py_ssize_t search_avx2(const char* haystack, Py_ssize_t len,
+        const char* needle, Py_ssize_t needle_len)
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[needle_len - 1]);
+    Py_ssize_t pos = 0;
+
+    for (; pos + needle_len + 31 <= len; pos += 32)
+    {
+        __m256i block_first = _mm256_loadu_si256(
+                (const __m256i*) (haystack + pos));
+        __m256i block_last = _mm256_loadu_si256(
+                (const __m256i*) (haystack + pos + needle_len - 1));
+
+        unsigned int mask = (unsigned int) _mm256_movemask_epi8(
+                _mm256_and_si256(
+                    _mm256_cmpeq_epi8(first, block_first),
+                    _mm256_cmpeq_epi8(last, block_last)));
+
+        while (mask)
+        {
+            int bit = __builtin_ctz(mask);
+            if (memcmp(haystack + pos + bit + 1, needle + 1,
+                    needle_len - 2) == 0)
+            {
+                return pos + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    Py_ssize_t found = search_sse2(haystack + pos, len - pos, needle,
+            needle_len);
+    return found < 0 ? found : pos + found;
+}
+
+#endif
+
+
+static search_function search_impl = search_scalar;
+
+
+/*
+ * Pick the fastest implementation supported by the running CPU.
+ */
+void circularbuffer_search_init(void)
+{
+#ifdef CIRCULARBUFFER_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        search_impl = search_avx2;
+    }
+    else if (__builtin_cpu_supports("sse2"))
+    {
+        search_impl = search_sse2;
+    }
+#endif
+}
+
+
+/*
+ * Index of the first occurence of needle in contiguous memory.
+ */
+Py_ssize_t circularbuffer_search(const char* haystack, Py_ssize_t len,
+        const char* needle, Py_ssize_t needle_len)
+{
+    if (needle_len <= 0 || needle_len > len)
+    {
+        return -1;
+    }
+    else if (needle_len == 1)
+    {
+        const char* found = (const char*) memchr(haystack, needle[0], len);
+        return found ? found - haystack : -1;
+    }
+    return search_impl(haystack, len, needle, needle_len);
+}
+
+
+/*
+ * Index of the first occurence of needle at or after start, in data made of
+ * one or two segments, including matches crossing from one to the other.
+ */
+Py_ssize_t circularbuffer_search_segments(CircularBufferSegment* segments,
+        int count, Py_ssize_t start, const char* needle,
+        Py_ssize_t needle_len)
+{
+    Py_ssize_t offset = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        const char* haystack = segments[i].ptr;
+        Py_ssize_t len = segments[i].len;
+
+        if (start < offset + len)
+        {
+            Py_ssize_t skip = start > offset ? start - offset : 0;
+            Py_ssize_t found = circularbuffer_search(haystack + skip,
+                    len - skip, needle, needle_len);
+
+            if (found >= 0)
+            {
+                return offset + skip + found;
+            }
+
+            // matches starting near the end of this segment
+            if (i + 1 < count)
+            {
+                const char* next = segments[i + 1].ptr;
+                Py_ssize_t next_len = segments[i + 1].len;
+                Py_ssize_t pos = len - needle_len + 1;
+                if (pos < skip)
+                {
+                    pos = skip;
+                }
+
+                for (; pos < len; pos++)
+                {
+                    Py_ssize_t head = len - pos;
+                    if (needle_len - head <= next_len
+                            && haystack[pos] == needle[0]
+                            && memcmp(haystack + pos, needle, head) == 0
+                            && memcmp(next, needle + head,
+                                needle_len - head) == 0)
+                    {
+                        return offset + pos;
+                    }
+                }
+            }
+        }
+        offset += len;
+    }
+    return -1;
+}
+
+
+/*
+ * Number of non-overlapping occurences of needle.
+ */
+Py_ssize_t circularbuffer_search_count(CircularBufferSegment* segments,
+        int count, const char* needle, Py_ssize_t needle_len)
+{
+    Py_ssize_t result = 0;
+    Py_ssize_t pos = 0;
+
+    if (needle_len <= 0)
+    {
+        return 0;
+    }
+    while ((pos = circularbuffer_search_segments(segments, count, pos, needle,
+            needle_len)) >= 0)
+    {
+        result += 1;
+        pos += needle_len;
+    }
+    return result;
+}
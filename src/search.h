@@ -0,0 +1,18 @@
+#ifndef CIRCULAR_BUFFER_SEARCH_H
+#define CIRCULAR_BUFFER_SEARCH_H
+
+#include "base.h"
+
+void circularbuffer_search_init(void);
+
+Py_ssize_t circularbuffer_search(const char* haystack, Py_ssize_t len,
+        const char* needle, Py_ssize_t needle_len);
+
+Py_ssize_t circularbuffer_search_segments(CircularBufferSegment* segments,
+        int count, Py_ssize_t start, const char* needle,
+        Py_ssize_t needle_len);
+
+Py_ssize_t circularbuffer_search_count(CircularBufferSegment* segments,
+        int count, const char* needle, Py_ssize_t needle_len);
+
+#endif
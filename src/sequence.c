@@ -1,4 +1,5 @@
 #define PY_SSIZE_T_CLEAN
+#include "search.h"
 #include "sequence.h"
 
 Py_ssize_t CircularBuffer_length(CircularBuffer* self)
@@ -30,55 +31,33 @@ int CircularBuffer_set_item(CircularBuffer* self, Py_ssize_t pos,
         return (int)translated_pos;
     }
     self->raw[translated_pos] = new_item[0];
+    // the byte may have been scanned for a delimiter already
+    self->scan_cursor = 0;
     return 0;
 }
 
 
 int CircularBuffer_contains(CircularBuffer* self, PyObject* item)
 {
-    const char* search = PyBytes_AsString(item);
-    Py_ssize_t search_len = strlen(search);
-    if (search_len > circularbuffer_total_length(self) || search_len == 0)
+    Py_buffer search;
+    if (PyObject_GetBuffer(item, &search, PyBUF_SIMPLE))
     {
-        return 0;
+        return -1;
     }
-    const char* psearch = search;
-    const char* psearch_end = psearch + search_len;
 
-    const char* pread = circularbuffer_readptr(self);
-    const char* pread_half_end;
-    const char* pread_end;
-    if (self->write < self->read)
+    int found = 0;
+    if (search.len <= circularbuffer_total_length(self) && search.len > 0)
     {
-        pread_half_end = self->raw + self->allocated_before_resize;
-        pread_end = self->raw + self->write;
-    }
-    else
-    {
-        pread_half_end = self->raw + self->write;
-        pread_end = self->raw + self->write;
-    }
+        CircularBufferSegment segments[2];
+        int count = circularbuffer_data_segments(self, 0,
+                circularbuffer_total_length(self), segments);
 
-    while (pread < pread_half_end)
-    {
-        psearch = pread[0] == psearch[0] ? psearch + 1 : search;
-        if (psearch == psearch_end)
-        {
-            return 1;
-        }
-        pread += 1;
-    }
-    while (pread < pread_end)
-    {
-        psearch = pread[0] == psearch[0] ? psearch + 1 : search;
-        if (psearch == psearch_end)
-        {
-            return 1;
-        }
-        pread += 1;
+        found = circularbuffer_search_segments(segments, count, 0,
+                (const char*) search.buf, search.len) >= 0;
     }
 
-    return 0;
+    PyBuffer_Release(&search);
+    return found;
 }
 
 
@@ -0,0 +1,720 @@
+#define PY_SSIZE_T_CLEAN
+#include "storage.h"
+
+#include <stdint.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define CIRCULARBUFFER_HAVE_MIRROR
+    #define CIRCULARBUFFER_HAVE_MMAP
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// MAP_HUGETLB maps the default huge page size, which is this on x86 and arm64
+#define CIRCULARBUFFER_HUGE_PAGE ((Py_ssize_t) 2 << 20)
+
+
+#ifdef CIRCULARBUFFER_HAVE_MIRROR
+
+/*
+ * Size of one half of mirrored storage, rounded up to whole pages.
+ */
+static Py_ssize_t mirror_length(Py_ssize_t size)
+{
+    Py_ssize_t page = (Py_ssize_t) sysconf(_SC_PAGESIZE);
+    return (size + 1 + page - 1) / page * page;
+}
+
+
+/*
+ * Anonymous shared memory file backing both halves.
+ */
+static int mirror_open(Py_ssize_t length)
+{
+#ifdef MFD_CLOEXEC
+    int fd = memfd_create("circularbuffer", MFD_CLOEXEC);
+#else
+    static unsigned int counter = 0;
+    char name[64];
+
+    snprintf(name, sizeof(name), "/circularbuffer-%ld-%u", (long) getpid(),
+            counter++);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0)
+    {
+        shm_unlink(name);
+    }
+#endif
+    if (fd >= 0 && ftruncate(fd, length) < 0)
+    {
+        int error = errno;
+        close(fd);
+        errno = error;
+        return -1;
+    }
+    return fd;
+}
+
+
+/*
+ * Map the same memory twice back to back, so reads and writes crossing the
+ * end of the first half land at the start of it.
+ */
+static char* mirror_map(Py_ssize_t length)
+{
+    int fd = mirror_open(length);
+    if (fd < 0)
+    {
+        PyErr_SetFromErrno(PyExc_OSError);
+        return NULL;
+    }
+
+    // reserve address space for both halves first
+    char* base = (char*) mmap(NULL, 2 * length, PROT_NONE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (base != MAP_FAILED)
+    {
+        if (mmap(base, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+                    fd, 0) == MAP_FAILED
+                || mmap(base + length, length, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+        {
+            int error = errno;
+            munmap(base, 2 * length);
+            errno = error;
+            base = MAP_FAILED;
+        }
+    }
+    if (base == MAP_FAILED)
+    {
+        PyErr_SetFromErrno(PyExc_OSError);
+        close(fd);
+        return NULL;
+    }
+
+    // the mappings keep the memory alive
+    close(fd);
+    return base;
+}
+
+#endif
+
+
+// internal buffer of empty heap storage, only NUL bytes are written there
+static char storage_empty[2];
+
+
+static char* align_pointer(char* ptr)
+{
+    return (char*) (((uintptr_t) ptr + CIRCULARBUFFER_CACHE_LINE - 1)
+            & ~(uintptr_t) (CIRCULARBUFFER_CACHE_LINE - 1));
+}
+
+
+/*
+ * Resize heap allocation, keeping raw aligned to a cache line. The first
+ * keep bytes of raw are preserved.
+ */
+static int heap_reallocate(CircularBuffer* self, Py_ssize_t size,
+        Py_ssize_t keep)
+{
+    if (size == 0)
+    {
+        // nothing to keep but the NUL bytes
+        PyMem_Free(self->block);
+        self->block = NULL;
+        self->raw = storage_empty;
+        return 0;
+    }
+
+    Py_ssize_t offset = self->block ? self->raw - self->block : 0;
+    char* block = (char*) PyMem_Realloc(self->block,
+            size + 2 + CIRCULARBUFFER_CACHE_LINE - 1);
+
+    if (block == NULL)
+    {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    char* raw = align_pointer(block);
+    if (self->block && raw - block != offset)
+    {
+        // realloc does not keep the alignment
+        memmove(raw, block + offset, keep);
+    }
+    self->block = block;
+    self->raw = raw;
+    return 0;
+}
+
+
+#ifdef CIRCULARBUFFER_HAVE_MMAP
+
+/*
+ * Round up to a multiple of alignment, which is a power of two.
+ */
+static Py_ssize_t round_up(Py_ssize_t size, Py_ssize_t alignment)
+{
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+
+/*
+ * Anonymous mapping of at least length bytes, from huge pages if asked for
+ * and available, otherwise transparent huge pages are requested.
+ */
+static char* map_anonymous(Py_ssize_t length, int huge, Py_ssize_t* mapped,
+        Py_ssize_t* page)
+{
+    char* raw;
+
+#ifdef MAP_HUGETLB
+    if (huge)
+    {
+        // fails unless the administrator has reserved huge pages
+        *mapped = round_up(length, CIRCULARBUFFER_HUGE_PAGE);
+        raw = (char*) mmap(NULL, *mapped, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (raw != MAP_FAILED)
+        {
+            *page = CIRCULARBUFFER_HUGE_PAGE;
+            return raw;
+        }
+    }
+#endif
+
+    *page = (Py_ssize_t) sysconf(_SC_PAGESIZE);
+    *mapped = round_up(length, huge ? CIRCULARBUFFER_HUGE_PAGE : *page);
+    raw = (char*) mmap(NULL, *mapped, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+    {
+        PyErr_SetFromErrno(PyExc_OSError);
+        return NULL;
+    }
+#ifdef MADV_HUGEPAGE
+    if (huge)
+    {
+        // only a hint, ignored where transparent huge pages are disabled
+        madvise(raw, *mapped, MADV_HUGEPAGE);
+    }
+#endif
+    return raw;
+}
+
+
+/*
+ * Make the mapping at least size + 2 bytes long, the first keep bytes of raw
+ * are preserved.
+ */
+static int map_reallocate(CircularBuffer* self, Py_ssize_t size,
+        Py_ssize_t keep)
+{
+    if (size + 2 <= self->mapped)
+    {
+        // pages released on shrink come back zeroed on first touch
+        return 0;
+    }
+
+    int huge = self->storage == CIRCULARBUFFER_STORAGE_HUGEPAGE;
+#ifdef MREMAP_MAYMOVE
+    if (!huge)
+    {
+        Py_ssize_t mapped = round_up(size + 2, self->page);
+        char* raw = (char*) mremap(self->raw, self->mapped, mapped,
+                MREMAP_MAYMOVE);
+
+        if (raw == MAP_FAILED)
+        {
+            PyErr_SetFromErrno(PyExc_OSError);
+            return -1;
+        }
+        self->raw = raw;
+        self->mapped = mapped;
+        return 0;
+    }
+#endif
+
+    Py_ssize_t mapped;
+    Py_ssize_t page;
+    char* raw = map_anonymous(size + 2, huge, &mapped, &page);
+    if (raw == NULL)
+    {
+        return -1;
+    }
+    memcpy(raw, self->raw, keep);
+    munmap(self->raw, self->mapped);
+
+    self->raw = raw;
+    self->mapped = mapped;
+    self->page = page;
+    return 0;
+}
+
+#endif
+
+
+/*
+ * Allocate internal buffer, its actual size could be larger than requested.
+ */
+int circularbuffer_storage_allocate(CircularBuffer* self, Py_ssize_t size)
+{
+    char* raw;
+
+    if (self->storage == CIRCULARBUFFER_STORAGE_MIRROR)
+    {
+#ifdef CIRCULARBUFFER_HAVE_MIRROR
+        Py_ssize_t length = mirror_length(size);
+        raw = mirror_map(length);
+        if (raw == NULL)
+        {
+            return -1;
+        }
+        // the last slot of the ring is raw[size + 1], which is raw[0] again
+        size = length - 1;
+#else
+        PyErr_SetString(PyExc_NotImplementedError, "Mirrored storage is not "
+                "supported on this platform.");
+
+        return -1;
+#endif
+    }
+#ifdef CIRCULARBUFFER_HAVE_MMAP
+    else if (self->storage == CIRCULARBUFFER_STORAGE_MMAP
+            || self->storage == CIRCULARBUFFER_STORAGE_HUGEPAGE)
+    {
+        raw = map_anonymous(size + 2,
+                self->storage == CIRCULARBUFFER_STORAGE_HUGEPAGE,
+                &self->mapped, &self->page);
+
+        if (raw == NULL)
+        {
+            return -1;
+        }
+    }
+#endif
+    else if (size == 0)
+    {
+        // allocated on first write
+        self->storage = CIRCULARBUFFER_STORAGE_HEAP;
+        raw = storage_empty;
+    }
+    else
+    {
+        // platforms without mmap fall back to the heap
+        self->storage = CIRCULARBUFFER_STORAGE_HEAP;
+        self->block = (char*) PyMem_Malloc(size + 2
+                + CIRCULARBUFFER_CACHE_LINE - 1);
+
+        if (self->block == NULL)
+        {
+            PyErr_NoMemory();
+            return -1;
+        }
+        raw = align_pointer(self->block);
+    }
+
+    self->raw = raw;
+    self->allocated = size;
+    self->allocated_before_resize = size;
+    self->raw[0] = 0;
+    self->raw[size + 1] = 0;
+    return 0;
+}
+
+
+/*
+ * Place internal buffer into named shared memory, behind a header with the
+ * indices. The name is the one multiprocessing.shared_memory uses.
+ */
+int circularbuffer_storage_share(CircularBuffer* self, const char* name,
+        Py_ssize_t size, int create)
+{
+#ifdef CIRCULARBUFFER_HAVE_MMAP
+    Py_ssize_t header = sizeof(CircularBufferSharedHeader);
+    char path[256];
+
+    snprintf(path, sizeof(path), "%s%s", name[0] == '/' ? "" : "/", name);
+    int fd = shm_open(path, create ? O_RDWR | O_CREAT | O_EXCL : O_RDWR,
+            0600);
+
+    if (fd < 0)
+    {
+        PyErr_SetFromErrnoWithFilename(PyExc_OSError, path);
+        return -1;
+    }
+
+    Py_ssize_t length = header + size + 2;
+    struct stat st;
+    if (create ? ftruncate(fd, length) < 0 : fstat(fd, &st) < 0)
+    {
+        PyErr_SetFromErrnoWithFilename(PyExc_OSError, path);
+        close(fd);
+        if (create)
+        {
+            shm_unlink(path);
+        }
+        return -1;
+    }
+    else if (!create && (Py_ssize_t) st.st_size < header + 2)
+    {
+        close(fd);
+        PyErr_Format(PyExc_ValueError, "Shared memory '%s' does not hold "
+                "a circular buffer.", path);
+        return -1;
+    }
+    else if (!create)
+    {
+        length = (Py_ssize_t) st.st_size;
+    }
+
+    char* base = (char*) mmap(NULL, length, PROT_READ | PROT_WRITE,
+            MAP_SHARED, fd, 0);
+    int error = errno;
+    close(fd);
+
+    if (base == MAP_FAILED)
+    {
+        errno = error;
+        PyErr_SetFromErrnoWithFilename(PyExc_OSError, path);
+        if (create)
+        {
+            shm_unlink(path);
+        }
+        return -1;
+    }
+
+    CircularBufferSharedHeader* shared = (CircularBufferSharedHeader*) base;
+    if (create)
+    {
+        // a fresh segment is zeroed, indices start at 0
+        shared->allocated = size;
+        memcpy(shared->magic, CIRCULARBUFFER_SHARED_MAGIC, 8);
+
+        self->shared_name = (char*) PyMem_Malloc(strlen(path) + 1);
+        if (self->shared_name == NULL)
+        {
+            munmap(base, length);
+            shm_unlink(path);
+            PyErr_NoMemory();
+            return -1;
+        }
+        strcpy(self->shared_name, path);
+    }
+    else if (memcmp(shared->magic, CIRCULARBUFFER_SHARED_MAGIC, 8) != 0
+            || shared->allocated < 0
+            || header + shared->allocated + 2 > length)
+    {
+        munmap(base, length);
+        PyErr_Format(PyExc_ValueError, "Shared memory '%s' does not hold "
+                "a circular buffer.", path);
+        return -1;
+    }
+
+    self->storage = CIRCULARBUFFER_STORAGE_SHARED;
+    self->shared = shared;
+    self->mapped = length;
+    self->raw = base + header;
+    self->allocated = shared->allocated;
+    self->allocated_before_resize = shared->allocated;
+    self->read = CIRCULARBUFFER_LOAD_ACQUIRE(shared->read);
+    self->write = CIRCULARBUFFER_LOAD_ACQUIRE(shared->write);
+    return 0;
+#else
+    PyErr_SetString(PyExc_NotImplementedError, "Shared storage is not "
+            "supported on this platform.");
+
+    return -1;
+#endif
+}
+
+
+/*
+ * Increase the size of internal buffer, keeping stored data.
+ */
+int circularbuffer_storage_resize(CircularBuffer* self, Py_ssize_t size)
+{
+    if (self->spsc)
+    {
+        circularbuffer_raise(self, ReservedError, "The internal buffer of "
+                "single-producer single-consumer buffer cannot be resized.");
+
+        return -1;
+    }
+    else if (self->write_lock || self->read_write_lock)
+    {
+        // internal buffer may move, while someone still points into it
+        circularbuffer_raise(self, ReservedError, "The internal buffer cannot "
+                "be modified at the moment.");
+
+        return -1;
+    }
+    // reserved free space may not be where it was
+    self->reserved = 0;
+
+    if (self->storage == CIRCULARBUFFER_STORAGE_MIRROR)
+    {
+#ifdef CIRCULARBUFFER_HAVE_MIRROR
+        Py_ssize_t length = mirror_length(size);
+        char* raw = mirror_map(length);
+        if (raw == NULL)
+        {
+            return -1;
+        }
+
+        // stored data is contiguous, move it to the start of the new mapping
+        Py_ssize_t len = circularbuffer_total_length(self);
+        memcpy(raw, circularbuffer_readptr(self), len);
+        munmap(self->raw, 2 * (self->allocated + 1));
+
+        self->raw = raw;
+        self->read = 0;
+        self->write = len;
+        self->allocated = length - 1;
+        self->allocated_before_resize = self->allocated;
+        self->raw[len] = 0;
+        if (self->capacity < self->allocated)
+        {
+            self->capacity = self->allocated;
+        }
+        self->stats.resizes++;
+#endif
+        return 0;
+    }
+
+    int result;
+#ifdef CIRCULARBUFFER_HAVE_MMAP
+    if (self->storage != CIRCULARBUFFER_STORAGE_HEAP)
+    {
+        result = map_reallocate(self, size, self->allocated + 2);
+    }
+    else
+#endif
+    {
+        result = heap_reallocate(self, size, self->allocated + 2);
+    }
+    if (result)
+    {
+        return -1;
+    }
+
+    if (self->write < self->read)
+    {
+        // stored data wraps around, move one of its segments so the new
+        // space ends up between them
+        Py_ssize_t end = self->allocated_before_resize + 1;
+        Py_ssize_t head = self->write;
+        Py_ssize_t tail = end - self->read;
+
+        if (head <= tail && head <= size + 1 - end)
+        {
+            memcpy(&self->raw[end], self->raw, head);
+            self->write = end + head > size ? 0 : end + head;
+        }
+        else
+        {
+            memmove(&self->raw[size + 1 - tail], &self->raw[self->read], tail);
+            self->read = size + 1 - tail;
+        }
+    }
+
+    self->raw[self->write] = 0;
+    self->raw[size + 1] = 0;
+    self->allocated = size;
+    self->allocated_before_resize = size;
+    if (self->capacity < size)
+    {
+        self->capacity = size;
+    }
+    self->stats.resizes++;
+    return 0;
+}
+
+
+/*
+ * Decrease the size of internal buffer down to size, which must hold the
+ * stored data. Memory mappings give the released pages back to the system
+ * but keep the address space, growing again does not move them.
+ */
+int circularbuffer_storage_shrink(CircularBuffer* self, Py_ssize_t size)
+{
+    Py_ssize_t len = circularbuffer_total_length(self);
+
+    if (size >= self->allocated || len > size
+            || self->storage == CIRCULARBUFFER_STORAGE_MIRROR)
+    {
+        return 0;
+    }
+    else if (self->spsc || self->write_lock || self->read_write_lock)
+    {
+        circularbuffer_raise(self, ReservedError, "The internal buffer cannot "
+                "be modified at the moment.");
+
+        return -1;
+    }
+    else if (circularbuffer_make_contiguous(self))
+    {
+        return -1;
+    }
+
+    // data goes to the start, the end of internal buffer is cut off
+    memmove(self->raw, &self->raw[self->read], len);
+    self->read = 0;
+    self->write = len;
+    self->reserved = 0;
+
+#ifdef CIRCULARBUFFER_HAVE_MMAP
+    if (self->storage != CIRCULARBUFFER_STORAGE_HEAP)
+    {
+        Py_ssize_t keep = round_up(size + 2, self->page);
+        if (keep < self->mapped)
+        {
+            madvise(self->raw + keep, self->mapped - keep, MADV_DONTNEED);
+        }
+    }
+    else
+#endif
+    if (heap_reallocate(self, size, len + 1))
+    {
+        return -1;
+    }
+
+    self->raw[len] = 0;
+    self->raw[size + 1] = 0;
+    self->allocated = size;
+    self->allocated_before_resize = size;
+    self->stats.resizes++;
+    return 0;
+}
+
+
+/*
+ * Largest size internal buffer may grow to on its own.
+ */
+Py_ssize_t circularbuffer_storage_limit(CircularBuffer* self)
+{
+    if (self->elastic && self->capacity > self->max_size)
+    {
+        return self->capacity;
+    }
+    return self->max_size;
+}
+
+
+/*
+ * Make room for size more bytes, doubling internal buffer up to the limit.
+ * Buffers in use by someone else are left as they are.
+ */
+int circularbuffer_storage_grow(CircularBuffer* self, Py_ssize_t size)
+{
+    Py_ssize_t len = circularbuffer_total_length(self);
+    Py_ssize_t allocated = self->allocated > 0 ? self->allocated : 1;
+    Py_ssize_t limit = circularbuffer_storage_limit(self);
+
+    if (self->spsc || self->read_write_lock || len + size <= self->allocated)
+    {
+        return 0;
+    }
+    while (allocated < len + size && allocated < limit)
+    {
+        allocated *= 2;
+    }
+    if (allocated > limit)
+    {
+        allocated = limit;
+    }
+    return circularbuffer_storage_resize(self, allocated);
+}
+
+
+/*
+ * Allocate elastic storage before up to size bytes, or as many as fit when
+ * negative, are written straight into internal buffer.
+ */
+int circularbuffer_storage_prepare(CircularBuffer* self, Py_ssize_t size)
+{
+    if (!self->elastic)
+    {
+        return 0;
+    }
+
+    Py_ssize_t wanted = self->capacity - circularbuffer_total_length(self);
+    if (size >= 0 && size < wanted)
+    {
+        wanted = size;
+    }
+    if (wanted > circularbuffer_total_available(self))
+    {
+        return circularbuffer_storage_grow(self, wanted);
+    }
+    return 0;
+}
+
+
+/*
+ * Give memory of drained elastic buffer back, down to min_size. Nothing
+ * happens while someone points into internal buffer.
+ */
+void circularbuffer_storage_idle(CircularBuffer* self)
+{
+    if (self->allocated <= self->min_size || self->spsc || self->read_lock
+            || self->read_write_lock || self->write_lock || self->reserved)
+    {
+        return;
+    }
+    if (circularbuffer_storage_shrink(self, self->min_size))
+    {
+        // shrinking in place does not fail in practice, keep what there is
+        PyErr_Clear();
+    }
+}
+
+
+/*
+ * Release internal buffer.
+ */
+void circularbuffer_storage_free(CircularBuffer* self)
+{
+    if (self->raw == NULL)
+    {
+        return;
+    }
+#ifdef CIRCULARBUFFER_HAVE_MIRROR
+    if (self->storage == CIRCULARBUFFER_STORAGE_MIRROR)
+    {
+        munmap(self->raw, 2 * (self->allocated + 1));
+        self->raw = NULL;
+        return;
+    }
+#endif
+#ifdef CIRCULARBUFFER_HAVE_MMAP
+    if (self->storage == CIRCULARBUFFER_STORAGE_SHARED)
+    {
+        munmap(self->shared, self->mapped);
+        if (self->shared_name)
+        {
+            // mappings of other processes stay valid
+            shm_unlink(self->shared_name);
+            PyMem_Free(self->shared_name);
+            self->shared_name = NULL;
+        }
+        self->shared = NULL;
+        self->raw = NULL;
+        return;
+    }
+    else if (self->storage != CIRCULARBUFFER_STORAGE_HEAP)
+    {
+        munmap(self->raw, self->mapped);
+        self->raw = NULL;
+        return;
+    }
+#endif
+    PyMem_Free(self->block);
+    self->block = NULL;
+    self->raw = NULL;
+}
@@ -0,0 +1,25 @@
+#ifndef CIRCULAR_BUFFER_STORAGE_H
+#define CIRCULAR_BUFFER_STORAGE_H
+
+#include "base.h"
+
+int circularbuffer_storage_allocate(CircularBuffer* self, Py_ssize_t size);
+
+int circularbuffer_storage_share(CircularBuffer* self, const char* name,
+        Py_ssize_t size, int create);
+
+int circularbuffer_storage_resize(CircularBuffer* self, Py_ssize_t size);
+
+int circularbuffer_storage_shrink(CircularBuffer* self, Py_ssize_t size);
+
+Py_ssize_t circularbuffer_storage_limit(CircularBuffer* self);
+
+int circularbuffer_storage_grow(CircularBuffer* self, Py_ssize_t size);
+
+int circularbuffer_storage_prepare(CircularBuffer* self, Py_ssize_t size);
+
+void circularbuffer_storage_idle(CircularBuffer* self);
+
+void circularbuffer_storage_free(CircularBuffer* self);
+
+#endif
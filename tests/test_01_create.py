@@ -1,4 +1,5 @@
-from circularbuffer import CircularBuffer
+from circularbuffer import CircularBuffer, ReservedError
+from pytest import raises
 
 BUFFER_SIZE = 256
 
@@ -11,3 +12,20 @@ def test_create():
     buf = CircularBuffer(size=BUFFER_SIZE)
     assert isinstance(buf, CircularBuffer)
     assert repr(buf) == '<CircularBuffer[0]:>'
+
+
+def test_reinitialize_in_use():
+    buf = CircularBuffer(10, mirror=True)
+    buf.write(b'abc')
+    view = memoryview(buf)
+    with raises(ReservedError):
+        buf.__init__(10)
+    assert bytes(view) == b'abc'
+    view.release()
+
+    buf.reserve(2)
+    with raises(ReservedError):
+        buf.__init__(10)
+    buf.commit(0)
+    buf.__init__(10)
+    assert len(buf) == 0
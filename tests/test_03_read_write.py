@@ -36,16 +36,16 @@ def test_read_write():
     assert str(buf) == '123456789012123'
 
     assert buf.resize(20) == 20
-    #'2123#12345678901     #'
-    assert buf.write_available() == 0
+    #'     123456789012123#'
+    assert buf.write_available() == 5
     assert str(buf) == '123456789012123'
 
     assert buf.read(10) == b'1234567890'
-    #'2123#          1     #'
-    assert buf.write_available() == 10
+    #'               12123#'
+    assert buf.write_available() == 15
     assert str(buf) == '12123'
 
     assert buf.read(2) == b'12'
-    #' 123#                #'
+    #'                 123#'
     assert buf.write_available() == 17
     assert str(buf) == '123'
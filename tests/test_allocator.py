@@ -0,0 +1,30 @@
+import ctypes
+
+from circularbuffer import CircularBuffer
+from pytest import raises
+
+def address(view):
+    return ctypes.addressof(ctypes.c_char.from_buffer(view))
+
+
+def test_allocator():
+    for allocator in ('malloc', 'mmap', 'hugepage'):
+        buf = CircularBuffer(10, allocator=allocator)
+        view = buf.reserve()
+        assert address(view) % 64 == 0
+        del view
+
+        buf.write(b'12345678')
+        buf.read(6)
+        assert buf.write(b'abcdefgh') == 8
+        assert buf.resize(100000) == 100000
+        assert buf.write(b'x' * 1000) == 1000
+        assert buf.read(10) == b'78abcdefgh'
+        assert buf.read(-1) == b'x' * 1000
+
+
+def test_allocator_invalid():
+    with raises(ValueError):
+        CircularBuffer(10, allocator='tcmalloc')
+    with raises(ValueError):
+        CircularBuffer(10, mirror=True, allocator='mmap')
@@ -0,0 +1,27 @@
+from circularbuffer import CircularBuffer
+from pytest import raises
+
+def test_arguments():
+    buf = CircularBuffer(10)
+    assert buf.write(data=b'12345') == 5
+    assert buf.find(b'3', end=-1) == 2
+    assert buf.find(b'3', 3) == -1
+    assert buf.index(sub=b'4', start=1, end=5) == 3
+    assert buf.count(text=b'1') == 1
+    assert buf.startswith(prefix=b'12') is True
+    assert buf.read(size=2) == b'12'
+
+    with raises(TypeError):
+        buf.read()
+    with raises(TypeError):
+        buf.read(1, 2)
+    with raises(TypeError):
+        buf.read(1, size=2)
+    with raises(TypeError):
+        buf.read(length=2)
+    with raises(TypeError):
+        buf.read(1.5)
+    with raises(TypeError):
+        buf.write(u'abc')
+    with raises(TypeError):
+        buf.find(b'1', '2')
@@ -0,0 +1,48 @@
+from circularbuffer import CircularBuffer
+from pytest import raises
+
+def test_elastic():
+    buf = CircularBuffer(1000, elastic=True)
+    assert buf.write_available() == 1000
+    assert buf.write(b'x' * 600) == 600
+    assert buf.stats()['resizes'] == 1
+    assert buf.write(b'y' * 600) == 400
+    assert buf.write_available() == 0
+
+    assert buf.read(900) == b'x' * 600 + b'y' * 300
+    assert buf.write(b'z' * 10) == 10
+    assert buf.read(-1) == b'y' * 100 + b'z' * 10
+    # grown once, drained and given back
+    assert buf.stats()['resizes'] == 2
+    assert buf.write_available() == 1000
+    assert buf.resize(2000) == 2000
+    assert buf.write(b'a' * 1500) == 1500
+    assert buf.read(-1) == b'a' * 1500
+
+
+def test_elastic_min_size():
+    for allocator in ('malloc', 'mmap'):
+        buf = CircularBuffer(100, elastic=True, min_size=16,
+                             allocator=allocator)
+        buf.write(b'0123456789')
+        buf.read(-1)
+        buf.write(b'0123456789')
+        buf.clear()
+        # stays within min_size
+        assert buf.stats()['resizes'] == 0
+        buf.write(b'x' * 50)
+        buf.read(-1)
+        assert buf.stats()['resizes'] == 2
+
+
+def test_elastic_reserve():
+    buf = CircularBuffer(64, elastic=True)
+    view = buf.reserve(8)
+    assert len(view) == 8
+    view[:] = b'abcdefgh'
+    del view
+    buf.commit(8)
+    assert buf.read(-1) == b'abcdefgh'
+
+    with raises(ValueError):
+        CircularBuffer(64, elastic=True, spsc=True)
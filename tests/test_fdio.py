@@ -0,0 +1,35 @@
+import os
+from circularbuffer import CircularBuffer
+
+def test_fill_drain():
+    buf = CircularBuffer(10)
+    r, w = os.pipe()
+    try:
+        os.write(w, b'1234567')
+        assert buf.fill_from_fd(r) == 7
+        assert buf.read(5) == b'12345'
+
+        # free space wraps around
+        os.write(w, b'abcdefghij')
+        assert buf.fill_from_fd(r, 100) == 8
+        assert str(buf) == '67abcdefgh'
+        assert buf.fill_from_fd(r) == 0
+
+        # data wraps around
+        assert buf.drain_to_fd(w, 9) == 9
+        assert os.read(r, 100) == b'ij67abcdefg'
+        assert str(buf) == 'h'
+        assert buf.drain_to_fd(w) == 1
+        assert os.read(r, 100) == b'h'
+        assert buf.drain_to_fd(w) == 0
+    finally:
+        os.close(r)
+        os.close(w)
+
+
+def test_fill_eof():
+    buf = CircularBuffer(10)
+    r, w = os.pipe()
+    os.close(w)
+    with os.fdopen(r, 'rb') as f:
+        assert buf.fill_from_fd(f) == 0
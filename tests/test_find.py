@@ -16,3 +16,14 @@ def test_find():
 
     with raises(ValueError):
         buf.find(b'')
+
+
+def test_find_two_segments():
+    buf = CircularBuffer(10)
+    buf.write(b'1234567890')
+    buf.read(8)
+    buf.write(b'abcd')
+    assert str(buf) == '90abcd'
+    assert buf[2] == b'a'
+    assert buf.find(b'0a') == 1
+    assert buf.find(b'c', 3) == 4
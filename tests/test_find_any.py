@@ -0,0 +1,64 @@
+import random
+from circularbuffer import CircularBuffer, Matcher
+from pytest import raises
+
+def test_find_any():
+    matcher = Matcher([b'\r\nOK\r\n', b'\r\nERROR\r\n', b'+CMS ERROR:', b'> '])
+    assert len(matcher) == 4
+    assert matcher[1] == b'\r\nERROR\r\n'
+
+    buf = CircularBuffer(32)
+    assert buf.find_any(matcher) == (-1, -1)
+    buf.write(b'AT+CMGS\r\n> ')
+    assert buf.find_any(matcher) == (9, 3)
+    buf.read(11)
+    # crossing the wrap point
+    buf.write(b'xxxxxxxxxxxxxxxxxxxxxx\r\nERROR\r\n')
+    buf.read(20)
+    assert buf.find_any(matcher) == (2, 1)
+    assert buf.find_any(matcher, 3) == (-1, -1)
+    assert buf.find_any(matcher, 0, 5) == (-1, -1)
+    assert buf.count_any(matcher) == (0, 1, 0, 0)
+
+    with raises(ValueError):
+        Matcher([])
+    with raises(ValueError):
+        Matcher([b'a', b''])
+    with raises(ValueError):
+        Matcher([b'ab', b'c', b'ab'])
+    with raises(TypeError):
+        buf.find_any([b'a'])
+    with raises(ValueError):
+        buf.find_any(Matcher.__new__(Matcher))
+    with raises(ValueError):
+        buf.count_any(Matcher.__new__(Matcher))
+
+
+def test_find_any_leftmost():
+    matcher = Matcher([b'bcd', b'abcdef', b'ab'])
+    buf = CircularBuffer(16)
+    buf.write(b'xabcdefg')
+    # lowest index wins, then the pattern listed first
+    assert buf.find_any(matcher) == (1, 1)
+    assert buf.count_any(matcher) == (1, 1, 1)
+
+
+def test_find_any_random():
+    rnd = random.Random(4321)
+    for _ in range(100):
+        patterns = list(dict.fromkeys(
+                bytes(rnd.choice(b'abc') for _ in range(rnd.randrange(1, 5)))
+                for _ in range(rnd.randrange(1, 6))))
+        matcher = Matcher(patterns)
+        data = bytes(rnd.choice(b'abcd') for _ in range(rnd.randrange(1, 200)))
+
+        buf = CircularBuffer(len(data) + 3)
+        offset = rnd.randrange(len(data) + 3)
+        buf.write(b'.' * offset)
+        buf.read(offset)
+        buf.write(data)
+
+        found = [(data.find(p), i) for i, p in enumerate(patterns)]
+        found = [f for f in found if f[0] >= 0]
+        assert buf.find_any(matcher) == (min(found) if found else (-1, -1))
+        assert buf.count_any(matcher) == tuple(data.count(p) for p in patterns)
@@ -0,0 +1,49 @@
+from circularbuffer import CircularBuffer
+
+def test_grow():
+    buf = CircularBuffer(4, max_size=20)
+    assert buf.write(b'123') == 3
+    assert buf.write(b'45678') == 5
+    assert buf.write_available() == 0
+    assert str(buf) == '12345678'
+
+    # capped at max_size
+    assert buf.write(b'abcdefghijklmnop') == 12
+    assert str(buf) == '12345678abcdefghijkl'
+
+
+def test_grow_wrapped():
+    buf = CircularBuffer(10, max_size=100)
+    buf.write(b'1234567890')
+    buf.read(7)
+    buf.write(b'abcdefg')
+    assert buf.write(b'ABCDEFGHIJKL') == 12
+    assert str(buf) == '890abcdefgABCDEFGHIJKL'
+    assert buf.read(-1) == b'890abcdefgABCDEFGHIJKL'
+
+
+def test_resize_wrapped():
+    # moving the shorter head segment
+    buf = CircularBuffer(10)
+    buf.write(b'1234567890')
+    buf.read(5)
+    buf.write(b'ab')
+    assert buf.resize(20) == 20
+    assert buf.write_available() == 13
+    assert buf.write(b'x' * 20) == 13
+    assert buf.read(-1) == b'67890ab' + b'x' * 13
+
+    # moving the shorter tail segment
+    buf = CircularBuffer(10)
+    buf.write(b'1234567890')
+    buf.read(9)
+    buf.write(b'abcdefgh')
+    assert buf.resize(12) == 12
+    assert buf.write_available() == 3
+    assert buf.write(b'xyz') == 3
+    assert buf.read(-1) == b'0abcdefghxyz'
+
+
+def test_no_grow():
+    buf = CircularBuffer(4)
+    assert buf.write(b'123456') == 4
@@ -31,3 +31,26 @@ def test_make_contiguous():
     buf.make_contiguous()
     #'0121234567#'#
     assert str(buf) == '0121234567'
+
+
+def test_make_contiguous_large():
+    # segments larger than the scratch space are swapped block by block
+    for first, second in ((5000, 9000), (9000, 5000), (12288, 4096),
+                          (4097, 30000), (20000, 20000)):
+        size = first + second
+        buf = CircularBuffer(size)
+        buf.write(b'-' * (size + 1 - first))
+        buf.read(size + 1 - first)
+        data = bytes(bytearray(i % 251 for i in range(size)))
+        assert buf.write(data) == size
+        buf.make_contiguous()
+        assert buf.read(-1) == data
+
+
+def test_make_contiguous_empty():
+    buf = CircularBuffer(10)
+    buf.write(b'123456')
+    buf.read(6)
+    buf.make_contiguous()
+    # whole buffer is contiguous free space again
+    assert len(buf.reserve()) == 10
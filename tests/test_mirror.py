@@ -0,0 +1,41 @@
+import re
+import sys
+from circularbuffer import CircularBuffer
+from pytest import mark
+
+pytestmark = mark.skipif(sys.platform == 'win32',
+        reason='mirrored storage needs mmap')
+
+def test_mirror():
+    buf = CircularBuffer(10, mirror=True)
+    size = buf.write_available()
+    # rounded up to whole pages
+    assert size >= 10
+
+    assert buf.write(b'x' * (size - 4)) == size - 4
+    assert len(buf.read(size - 4)) == size - 4
+
+    # two segments in the ring, but one in virtual memory
+    assert buf.write(b'12345678') == 8
+    assert str(buf) == '12345678'
+    assert buf[3:6] == b'456'
+    assert buf.find(b'45') == 3
+    assert re.search(br'4567', buf) is not None
+    with buf:
+        assert bytes(memoryview(buf)) == b'12345678'
+
+    assert buf.write(b'x' * size) == size - 8
+    assert buf.write_available() == 0
+
+
+def test_mirror_resize():
+    buf = CircularBuffer(10, mirror=True)
+    size = buf.write_available()
+    buf.write(b'x' * (size - 2))
+    buf.read(size - 2)
+    buf.write(b'1234')
+
+    assert buf.resize(size + 1) > size
+    assert str(buf) == '1234'
+    assert buf.write(b'5678') == 4
+    assert buf.read(8) == b'12345678'
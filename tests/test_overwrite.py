@@ -0,0 +1,32 @@
+from circularbuffer import CircularBuffer, ReservedError
+from pytest import raises
+
+def test_overwrite():
+    buf = CircularBuffer(10, overwrite=True)
+    assert buf.write(b'1234567') == 7
+    assert buf.dropped() == 0
+    assert buf.write(b'abcdef') == 6
+    assert buf.dropped() == 3
+    assert str(buf) == '4567abcdef'
+
+    # only the tail of large data is kept
+    assert buf.write(b'ABCDEFGHIJKLMNO') == 15
+    assert buf.dropped() == 18
+    assert str(buf) == 'FGHIJKLMNO'
+    assert buf.read(-1) == b'FGHIJKLMNO'
+
+
+def test_overwrite_pinned():
+    buf = CircularBuffer(4, overwrite=True)
+    buf.write(b'1234')
+    views = buf.peek_view()
+    with raises(ReservedError):
+        buf.write(b'5')
+    del views
+    assert buf.write(b'5') == 1
+    assert str(buf) == '2345'
+
+
+def test_overwrite_spsc():
+    with raises(ValueError):
+        CircularBuffer(4, spsc=True, overwrite=True)
@@ -0,0 +1,32 @@
+from circularbuffer import CircularBuffer, ReservedError
+from pytest import raises
+
+def test_peek_view():
+    buf = CircularBuffer(10)
+    assert buf.peek_view() == ()
+    buf.write(b'1234567890')
+    buf.read(7)
+    buf.write(b'abcd')
+
+    views = buf.peek_view(2)
+    assert len(views) == 1
+    assert views[0] == b'89'
+    assert views[0].readonly
+    with raises(ReservedError):
+        buf.read(1)
+    with raises(ReservedError):
+        buf.advance(1)
+    with raises(ReservedError):
+        buf.clear()
+    del views
+
+    views = buf.peek_view()
+    assert len(views) == 2
+    assert b''.join(views) == b'890abcd'
+    del views
+
+    assert buf.advance(4) == 4
+    assert str(buf) == 'bcd'
+    assert buf.discard(10) == 3
+    assert len(buf) == 0
+    assert buf.write_available() == 10
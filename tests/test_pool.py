@@ -0,0 +1,38 @@
+from circularbuffer import BufferPool, CircularBuffer
+from pytest import raises
+
+def test_pool():
+    pool = BufferPool(16, max_free=2)
+    buf = pool.acquire()
+    assert isinstance(buf, CircularBuffer)
+    assert buf.write_available() == 16
+    buf.write(b'hello')
+    buf.read_until(b'\n')
+    assert pool.release(buf)
+    assert len(pool) == 1
+    with raises(ValueError):
+        pool.release(buf)
+
+    # recycled buffer comes back empty
+    again = pool.acquire()
+    assert again is buf
+    assert len(again) == 0
+    assert again.stats()['bytes_written'] == 0
+
+    stats = pool.stats()
+    assert stats['acquires'] == 2
+    assert stats['hits'] == 1
+    assert stats['misses'] == 1
+    assert stats['hit_rate'] == 0.5
+
+
+def test_pool_discard():
+    pool = BufferPool(16, max_free=1)
+    assert not pool.release(CircularBuffer(32))
+    assert not pool.release(CircularBuffer(16, overwrite=True))
+    assert pool.release(CircularBuffer(16))
+    # beyond max_free
+    assert not pool.release(CircularBuffer(16))
+    assert pool.stats()['discarded'] == 3
+    with raises(TypeError):
+        pool.release(b'data')
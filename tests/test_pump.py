@@ -0,0 +1,92 @@
+import os
+import select
+from circularbuffer import CircularBuffer, RealignmentError, ReservedError
+from pytest import raises
+
+
+def wait_for(buf, notify, size):
+    data = b''
+    while len(data) < size:
+        assert select.select([notify], [], [], 5)[0]
+        data += buf.read(-1)
+    return data
+
+
+def test_pump():
+    buf = CircularBuffer(10)
+    r, w = os.pipe()
+    try:
+        notify = buf.start_pump(r, 4)
+        assert buf.is_pumping()
+        assert not select.select([notify], [], [], 0)[0]
+
+        os.write(w, b'123456')
+        assert wait_for(buf, notify, 6) == b'123456'
+        assert not select.select([notify], [], [], 0.05)[0]
+
+        # more than fits, the pump waits for the consumer
+        data = os.urandom(1000)
+        os.write(w, data)
+        assert wait_for(buf, notify, 1000) == data
+
+        buf.stop_pump()
+        assert not buf.is_pumping()
+        buf.write(b'abc')
+        assert str(buf) == 'abc'
+    finally:
+        os.close(r)
+        os.close(w)
+
+
+def test_pump_eof():
+    buf = CircularBuffer(10)
+    r, w = os.pipe()
+    notify = buf.start_pump(r)
+    os.write(w, b'abc')
+    os.close(w)
+    assert select.select([notify], [], [], 5)[0]
+    while buf.is_pumping():
+        select.select([notify], [], [], 0.01)
+    assert buf.read(-1) == b'abc'
+    buf.stop_pump()
+    os.close(r)
+
+
+def test_pump_reserve():
+    buf = CircularBuffer(10)
+    r, w = os.pipe()
+    try:
+        view = buf.reserve(3)
+        with raises(ReservedError):
+            buf.start_pump(r)
+        view.release()
+        buf.commit(0)
+
+        notify = buf.start_pump(r)
+        with raises(RealignmentError):
+            buf.reserve(3)
+        with raises(ReservedError):
+            buf.commit(0)
+        os.write(w, b'abcd')
+        assert wait_for(buf, notify, 4) == b'abcd'
+        buf.stop_pump()
+    finally:
+        os.close(r)
+        os.close(w)
+
+
+def test_pump_elastic():
+    buf = CircularBuffer(100, elastic=True)
+    r, w = os.pipe()
+    try:
+        for _ in range(2):
+            notify = buf.start_pump(r)
+            os.write(w, b'hello')
+            assert wait_for(buf, notify, 5) == b'hello'
+            buf.stop_pump()
+            # drained storage is released, the next pump grows it again
+            buf.write(b'x')
+            assert buf.read(1) == b'x'
+    finally:
+        os.close(r)
+        os.close(w)
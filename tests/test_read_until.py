@@ -0,0 +1,61 @@
+from circularbuffer import CircularBuffer
+
+def test_read_until():
+    buf = CircularBuffer(16)
+    buf.write(b'AT\r')
+    assert buf.read_until(b'\r\n') == b''
+    assert buf.write(b'\nOK\r') == 4
+    assert buf.read_until(b'\r\n') == b'AT\r\n'
+    assert buf.read_until(b'\r\n') == b''
+    buf.write(b'\n+CMTI\r\n')
+    assert buf.read_until(b'\r\n') == b'OK\r\n'
+    # crossing the wrap point
+    assert buf.read_until(b'\r\n') == b'+CMTI\r\n'
+    assert len(buf) == 0
+
+
+def test_read_until_max_bytes():
+    buf = CircularBuffer(16)
+    buf.write(b'123456')
+    assert buf.read_until(b'\n', 8) == b''
+    assert buf.read_until(b'\n', 4) == b'1234'
+    buf.write(b'7\n')
+    assert buf.read_until(b'\n', 3) == b'567'
+    assert buf.read_until(b'\n', 3) == b'\n'
+
+
+def test_read_until_other_delimiter():
+    buf = CircularBuffer(16)
+    buf.write(b'ab;cd\n')
+    assert buf.read_until(b'\r\n') == b''
+    assert buf.read_until(b';') == b'ab;'
+    assert buf.readline() == b'cd\n'
+    buf.write(b'ef')
+    assert buf.readline() == b''
+    buf.clear()
+    buf.write(b'\n')
+    assert buf.readline() == b'\n'
+
+
+def test_read_until_reinitialize():
+    buf = CircularBuffer(100)
+    buf.write(b'x' * 100)
+    assert buf.readline() == b''
+    buf.__init__(200)
+    buf.write(b'a\n')
+    assert buf.readline() == b'a\n'
+
+
+def test_read_until_modified():
+    buf = CircularBuffer(16)
+    buf.write(b'abcd')
+    assert buf.readline() == b''
+    buf[1] = b'\n'
+    assert buf.readline() == b'a\n'
+
+    buf.write(b'ef')
+    assert buf.readline() == b''
+    with memoryview(buf) as view:
+        view[0] = ord('\n')
+    assert buf.readline() == b'\n'
+    assert str(buf) == 'def'
@@ -0,0 +1,34 @@
+from circularbuffer import CircularBuffer
+
+def test_readinto():
+    buf = CircularBuffer(10)
+    out = bytearray(6)
+
+    assert buf.readinto(out) == 0
+    assert buf.write(b'1234567890') == 10
+    assert buf.readinto(out) == 6
+    assert out == b'123456'
+    assert buf.write(b'abc') == 3
+
+    # two segments
+    assert buf.readinto(memoryview(out)[1:]) == 5
+    assert out == b'17890a'
+    assert str(buf) == 'bc'
+    assert buf.write_available() == 8
+
+
+def test_peek_into():
+    buf = CircularBuffer(10)
+    buf.write(b'1234567890')
+    buf.read(8)
+    buf.write(b'abcd')
+    out = bytearray(4)
+
+    assert buf.peek_into(out) == 4
+    assert out == b'90ab'
+    assert buf.peek_into(out, 3) == 3
+    assert out == b'bcdb'
+    assert buf.peek_into(out, start=-2) == 2
+    assert out[:2] == b'cd'
+    assert buf.peek_into(out, 6) == 0
+    assert str(buf) == '90abcd'
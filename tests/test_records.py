@@ -0,0 +1,70 @@
+from circularbuffer import CircularBuffer
+from pytest import raises
+
+def test_records():
+    buf = CircularBuffer(20)
+    assert buf.read_record() is None
+    assert buf.peek_record_len() == -1
+
+    assert buf.write_record(b'hello')
+    assert buf.write_record(bytearray(b'abc'))
+    assert not buf.write_record(b'123456789')
+    assert len(buf) == 16
+    assert buf[:4] == b'\x05\x00\x00\x00'
+    assert buf.peek_record_len() == 5
+
+    assert buf.read_record() == b'hello'
+    # wraps around
+    assert buf.write_record(memoryview(b'123456789'))
+    assert not buf.write_record(b'')
+    assert buf.read_record() == b'abc'
+    assert buf.write_record(b'')
+    assert buf.read_records() == [b'123456789', b'']
+    assert buf.read_records() == []
+
+
+def test_records_partial():
+    buf = CircularBuffer(20)
+    buf.write(b'\x03\x00\x00')
+    assert buf.peek_record_len() == -1
+    buf.write(b'\x00ab')
+    assert buf.peek_record_len() == 3
+    assert buf.read_record() is None
+    buf.write(b'c')
+    assert buf.read_records(1) == [b'abc']
+
+
+def test_records_overwrite():
+    buf = CircularBuffer(20, overwrite=True)
+    buf.write_record(b'12345')
+    buf.write_record(b'abc')
+    assert buf.write_record(b'xyz')
+    assert buf.dropped() == 9
+    assert buf.read_records() == [b'abc', b'xyz']
+    assert not buf.write_record(b'x' * 17)
+
+
+def test_records_garbage():
+    buf = CircularBuffer(16, overwrite=True)
+    buf.write(b'\xff\xff\x00\x00xxxxxxxx')
+    assert buf.write_record(b'hello')
+    assert len(buf) == 9
+    assert buf.dropped() == 12
+    assert buf.read_record() == b'hello'
+
+    buf = CircularBuffer(16)
+    buf.write_record(b'ok')
+    buf.write(b'\xff\xff\x00\x00xx')
+    assert buf.read_records() == [b'ok']
+    with raises(ValueError):
+        buf.read_record()
+    with raises(ValueError):
+        buf.read_records()
+    assert len(buf) == 6
+    assert buf.dropped() == 0
+
+    buf = CircularBuffer(16, overwrite=True)
+    buf.write(b'\xff\xff\x00\x00xx')
+    assert buf.read_record() is None
+    assert len(buf) == 0
+    assert buf.dropped() == 6
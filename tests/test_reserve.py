@@ -0,0 +1,48 @@
+import io
+from circularbuffer import CircularBuffer, RealignmentError, ReservedError
+from pytest import raises
+
+def test_reserve_commit():
+    buf = CircularBuffer(10)
+    src = io.BytesIO(b'1234567890abc')
+
+    view = buf.reserve(4)
+    assert len(view) == 4
+    assert src.readinto(view) == 4
+    # resize and write would pull the memory away
+    with raises(ReservedError):
+        buf.resize(20)
+    with raises(RealignmentError):
+        buf.write(b'x')
+    del view
+    assert buf.commit(4) == 4
+    assert str(buf) == '1234'
+
+    assert buf.commit(src.readinto(buf.reserve())) == 6
+    assert buf.write_available() == 0
+    assert buf.read(7) == b'1234567'
+
+    # free space wraps, reserve again after commit for the rest
+    view = buf.reserve()
+    assert len(view) == 1
+    assert src.readinto(view) == 1
+    del view
+    buf.commit(1)
+    assert buf.commit(src.readinto(buf.reserve())) == 2
+    assert str(buf) == '890abc'
+    assert buf.write_available() == 4
+
+
+def test_reserve_errors():
+    buf = CircularBuffer(10)
+    view = buf.reserve(5)
+    with raises(ReservedError):
+        buf.reserve()
+    with raises(ValueError):
+        buf.commit(6)
+    view[:2] = b'12'
+    view.release()
+    assert buf.commit(2) == 2
+    assert str(buf) == '12'
+    with raises(ValueError):
+        buf.commit(1)
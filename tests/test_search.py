@@ -0,0 +1,42 @@
+import random
+from circularbuffer import CircularBuffer
+
+def wrapped(data, offset, size=None):
+    size = size or len(data) + 7
+    buf = CircularBuffer(size)
+    buf.write(b'.' * offset)
+    buf.read(offset)
+    assert buf.write(data) == len(data)
+    return buf
+
+
+def test_search_overlapping_candidate():
+    buf = wrapped(b'xaaab', 0)
+    assert buf.find(b'aab') == 2
+    assert buf.count(b'aab') == 1
+    assert b'aab' in buf
+
+
+def test_search_across_wrap():
+    data = b'0123456789' * 3
+    for offset in range(len(data) + 7):
+        buf = wrapped(data, offset)
+        assert str(buf) == data.decode()
+        for sub in (b'9', b'90', b'8901', b'567890123', b'xyz', data):
+            assert buf.find(sub) == data.find(sub)
+            assert buf.count(sub) == data.count(sub)
+            assert (sub in buf) == (sub in data)
+        assert buf.find(b'0', 5) == data.find(b'0', 5)
+        assert buf.startswith(b'0123') == 1
+
+
+def test_search_random():
+    rnd = random.Random(1234)
+    for _ in range(200):
+        data = bytes(rnd.choice(b'ab\r\n') for _ in range(rnd.randrange(1, 1500)))
+        buf = wrapped(data, rnd.randrange(len(data) + 7))
+        start = rnd.randrange(len(data))
+        sub = data[start:start + rnd.randrange(1, 40)]
+        assert buf.find(sub) == data.find(sub)
+        assert buf.find(sub, start) == data.find(sub, start)
+        assert buf.count(sub) == data.count(sub)
@@ -0,0 +1,29 @@
+import hashlib
+from circularbuffer import CircularBuffer, ReservedError
+from pytest import raises
+
+def test_segments():
+    buf = CircularBuffer(10)
+    assert buf.segments() == ()
+    buf.write(b'1234567890')
+    buf.read(7)
+    buf.write(b'abcd')
+
+    views = buf.segments()
+    assert [bytes(view) for view in views] == [b'890a', b'bcd']
+    with raises(ReservedError):
+        buf.read(1)
+    with raises(ReservedError):
+        buf.make_contiguous()
+    del views
+
+    assert b''.join(buf.segments(1, 5)) == b'90ab'
+    assert b''.join(buf.segments(-3)) == b'bcd'
+    assert buf.segments(5, 2) == ()
+
+    digest = hashlib.sha1()
+    for view in buf.segments():
+        digest.update(view)
+    del view
+    assert digest.digest() == hashlib.sha1(b'890abcd').digest()
+    assert buf.read(-1) == b'890abcd'
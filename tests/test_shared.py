@@ -0,0 +1,58 @@
+import os
+import subprocess
+import sys
+
+import circularbuffer
+from circularbuffer import CircularBuffer
+from pytest import raises
+
+def name(suffix):
+    return 'cbtest-%d-%s' % (os.getpid(), suffix)
+
+
+def test_shared():
+    producer = CircularBuffer(16, shared=name('a'), create=True)
+    consumer = CircularBuffer(0, shared=name('a'))
+    assert consumer.write_available() == 16
+
+    assert producer.write(b'0123456789') == 10
+    assert len(consumer) == 10
+    assert consumer.read(8) == b'01234567'
+    assert producer.write_available() == 14
+    # wraps around the end of the segment
+    assert producer.write(b'abcdefghijkl') == 12
+    assert consumer.find(b'ab') == 2
+    assert consumer.read(-1) == b'89abcdefghijkl'
+    assert len(producer) == 0
+
+    with raises(OSError):
+        CircularBuffer(16, shared=name('a'), create=True)
+    del producer
+    consumer.write(b'still mapped')
+    assert consumer.read(-1) == b'still mapped'
+    # the creator has unlinked the name
+    with raises(OSError):
+        CircularBuffer(0, shared=name('a'))
+
+
+def test_shared_process():
+    buf = CircularBuffer(1024, shared=name('b'), create=True)
+    code = ('from circularbuffer import CircularBuffer\n'
+            'buf = CircularBuffer(0, shared=%r)\n'
+            'buf.write(buf.read(-1).upper())\n' % name('b'))
+    buf.write(b'hello from the parent')
+    # the child imports the same extension, wherever it was built
+    path = [os.path.dirname(os.path.abspath(circularbuffer.__file__))]
+    if os.environ.get('PYTHONPATH'):
+        path.append(os.environ['PYTHONPATH'])
+    subprocess.check_call([sys.executable, '-c', code],
+                          env=dict(os.environ,
+                                   PYTHONPATH=os.pathsep.join(path)))
+    assert buf.read(-1) == b'HELLO FROM THE PARENT'
+
+
+def test_shared_invalid():
+    with raises(ValueError):
+        CircularBuffer(16, shared=name('c'), create=True, overwrite=True)
+    with raises(ValueError):
+        CircularBuffer(16, shared=name('c'), create=True, mirror=True)
@@ -0,0 +1,44 @@
+import hashlib
+import threading
+from circularbuffer import CircularBuffer, ReservedError
+from pytest import raises
+
+def test_spsc_threads():
+    buf = CircularBuffer(1 << 20, spsc=True)
+    chunk = bytes(range(256)) * 256
+    rounds = 200
+    produced = hashlib.sha1()
+    consumed = hashlib.sha1()
+
+    def producer():
+        for i in range(rounds):
+            data = chunk[i:] + chunk[:i]
+            produced.update(data)
+            while data:
+                data = data[buf.write(data):]
+
+    thread = threading.Thread(target=producer)
+    thread.start()
+    total = 0
+    while total < rounds * len(chunk):
+        data = buf.read(100000)
+        consumed.update(data)
+        total += len(data)
+    thread.join()
+
+    assert total == rounds * len(chunk)
+    assert consumed.digest() == produced.digest()
+
+
+def test_spsc_restrictions():
+    buf = CircularBuffer(10, spsc=True)
+    buf.write(b'1234567890')
+    buf.read(5)
+    buf.write(b'abc')
+    with raises(ReservedError):
+        buf.resize(20)
+    with raises(ReservedError):
+        buf.make_contiguous()
+    buf.clear()
+    assert len(buf) == 0
+    assert buf.write(b'1234567890') == 10
@@ -0,0 +1,33 @@
+from circularbuffer import CircularBuffer, ReservedError
+from pytest import raises
+
+def test_stats():
+    buf = CircularBuffer(10)
+    assert buf.stats()['writes'] == 0
+    assert buf.write(b'1234567') == 7
+    assert buf.read(3) == b'123'
+    assert buf.write(b'abcdefgh') == 6
+
+    stats = buf.stats()
+    assert stats['bytes_written'] == 13
+    assert stats['writes'] == 2
+    assert stats['short_writes'] == 1
+    assert stats['bytes_refused'] == 2
+    assert stats['high_watermark'] == 10
+    assert stats['bytes_read'] == 3
+    assert stats['reads'] == 1
+
+    buf.read(5)
+    buf.make_contiguous()
+    stats = buf.stats(reset=True)
+    assert stats['realignments'] == 1
+    assert stats['realigned_bytes'] == 5
+    assert buf.stats()['bytes_written'] == 0
+
+
+def test_stats_errors():
+    buf = CircularBuffer(10)
+    buf.reserve(4)
+    with raises(ReservedError):
+        buf.reserve(4)
+    assert buf.stats()['reserved_errors'] == 1
@@ -0,0 +1,28 @@
+import re
+from circularbuffer import CircularBuffer, ReservedError
+from pytest import raises
+
+def test_view():
+    buf = CircularBuffer(10)
+    assert buf.view() == b''
+    buf.write(b'1234567890')
+    buf.read(7)
+    buf.write(b'abcd')
+
+    # window before the end of internal buffer points into it
+    view = buf.view(0, 3)
+    assert view == b'890'
+    assert view.readonly
+    with raises(ReservedError):
+        buf.read(1)
+    del view
+
+    # window across the end is copied
+    view = buf.view(2)
+    assert view == b'0abcd'
+    assert buf.read(1) == b'8'
+    del view
+
+    assert re.match(b'90a', buf.view())
+    assert buf.view(-2) == b'cd'
+    assert buf.view(4, 2) == b''
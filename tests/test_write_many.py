@@ -0,0 +1,35 @@
+from circularbuffer import CircularBuffer
+from pytest import raises
+
+def test_write_many():
+    buf = CircularBuffer(10)
+    assert buf.write_many([]) == (0, 0)
+    assert buf.write_many([b'123', bytearray(b'45'), memoryview(b'6789')]) \
+        == (3, 9)
+    assert str(buf) == '123456789'
+
+    # whole items only, the count is where to continue from
+    buf.read(5)
+    items = (b'ab', b'cdefg', b'h')
+    assert buf.write_many(items) == (1, 2)
+    assert str(buf) == '6789ab'
+    buf.read(5)
+    assert buf.write_many(items[1:]) == (2, 6)
+    assert str(buf) == 'bcdefgh'
+
+
+def test_write_many_invalid():
+    buf = CircularBuffer(10)
+    with raises(TypeError):
+        buf.write_many([b'ab', bytearray(b'cd'), 'str', b'zz'])
+    with raises(TypeError):
+        buf.write_many(iter([b'ab']))
+    with raises(TypeError):
+        buf.write_many(b'ab' for _ in range(2))
+    assert len(buf) == 0
+
+
+def test_write_many_grow():
+    buf = CircularBuffer(4, max_size=16)
+    assert buf.write_many([b'1234', b'5678', b'abcdefgh', b'z']) == (3, 16)
+    assert str(buf) == '12345678abcdefgh'